@@ -18,16 +18,12 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
-#include <boost/assign.hpp>
-
 #include "English.hpp"
 
 #include "config.hpp"
-#include "strcvt.hpp"
 #include "espeak.hpp"
 
 using namespace std;
-using namespace boost::assign;
 
 
 // Static data:
@@ -45,6 +41,8 @@ language_description::options English::settings =
     .caps_factor = 1.2
   };
 
+const wchar_t* const English::alphabet = L"a-z";
+
 static const wchar_t* criterion =
   L"h(?:anded|ye|e(?:ep|a(?:rt|ts)))|"
   L"g(?:o|(?:a|et)t)ing|"
@@ -155,71 +153,81 @@ static const wchar_t* criterion =
   L")";
 
 
+// Punctuations pronunciation:
+static const wchar_t* const punctuation_names[punctuations::count] =
+  {
+    L" exclamation ",
+    L" apostrophe ",
+    L" question mark ",
+    L" comma ",
+    L" period ",
+    L" semicolon ",
+    L" colon ",
+    L" dash ",
+    L" at ",
+    L" pound ",
+    L" dollar ",
+    L" percent ",
+    L" caret ",
+    L" ampersand ",
+    L" star ",
+    L" underscore ",
+    L" left paren ",
+    L" right paren ",
+    L" plus ",
+    L" equals ",
+    L" left bracket ",
+    L" right bracket ",
+    L" left brace ",
+    L" right brace ",
+    L" backslash ",
+    L" pipe ",
+    L" quotes ",
+    L" slash ",
+    L" backquote ",
+    L" tilde ",
+    L" less than ",
+    L" greater than "
+  };
+
+// Letters dictionary:
+static const language_description::dictionary_item letters[] =
+  {
+    { L"newline", L"new line" },
+    { NULL, NULL }
+  };
+
+
 // Object construction:
 
 English::English(void):
-  language_description(lang_id::en, settings, L"a-z", criterion)
+  language_description(lang_id::en, settings, alphabet, criterion)
 {
-  // Punctuations pronunciation:
-  punctuations = list_of
-    (L" exclamation ")
-    (L" apostrophe ")
-    (L" question mark ")
-    (L" comma ")
-    (L" period ")
-    (L" semicolon ")
-    (L" colon ")
-    (L" dash ")
-    (L" at ")
-    (L" pound ")
-    (L" dollar ")
-    (L" percent ")
-    (L" caret ")
-    (L" ampersand ")
-    (L" star ")
-    (L" underscore ")
-    (L" left paren ")
-    (L" right paren ")
-    (L" plus ")
-    (L" equals ")
-    (L" left bracket ")
-    (L" right bracket ")
-    (L" left brace ")
-    (L" right brace ")
-    (L" backslash ")
-    (L" pipe ")
-    (L" quotes ")
-    (L" slash ")
-    (L" backquote ")
-    (L" tilde ")
-    (L" less than ")
-    (L" greater than ")
-    .convert_to_container< vector<const wchar_t*> >();
-
   // Letters dictionary:
-  dictionary = map_list_of
-    (L"newline", L"new line")
+  dictionary = letters;
 
-    // Language name:
-    (intern_string(id).c_str(), L"English")
-    .convert_to_container< map<const wstring, const wchar_t*> >();
+  // Language name:
+  language_name = L"English";
 
   // Text filtering chain:
   filter_chain.setup()
     (L"\\.,", L" dot comma ")
     (L"\\.{3}", L" dot dot dot ")
     (L"\\.{2}", L" dot dot ")
-    (L"([a-z])\\.([a-z])", L"$1 dot $2", true)
-    (L"([0-9])\\.([0-9])", L"$1period$2")
+    (substitution_set()
+     (L"([a-z])\\.([a-z])", L"$1 dot $2", true)
+     (L"([0-9])\\.([0-9])", L"$1period$2"))
     (L"[\\+-]?[0-9]+|_", L" $& ")
-    (L"(^| ) ((?:[0-9]*[02-9])?1) (st)\\>", L"$1$2$3", true)
-    (L"(^| ) ((?:[0-9]*[02-9])?2) (nd)\\>", L"$1$2$3", true)
-    (L"(^| ) ((?:[0-9]*[02-9])?3) (rd)\\>", L"$1$2$3", true)
-    (L"(^| ) ([0-9]*[04-9]) (th)\\>", L"$1$2$3", true)
-    (L"(^| ) ([0-9]*1[1-3]) (th)\\>", L"$1$2$3", true)
-    (punctuations)
+    (substitution_set()
+     (L"(^| ) ((?:[0-9]*[02-9])?1) (st)\\>", L"$1$2$3", true)
+     (L"(^| ) ((?:[0-9]*[02-9])?2) (nd)\\>", L"$1$2$3", true)
+     (L"(^| ) ((?:[0-9]*[02-9])?3) (rd)\\>", L"$1$2$3", true)
+     (L"(^| ) ([0-9]*[04-9]) (th)\\>", L"$1$2$3", true)
+     (L"(^| ) ([0-9]*1[1-3]) (th)\\>", L"$1$2$3", true))
+    (punctuation_names)
     (L"(^|[^'])\\<[bcdfghj-np-tvwxz]+\\>([^']|$)", spell(this), true)
     (L"[^\\.,!\\?';\\:0-9a-z]", L" ", true)
-    (L"(^[^-0-9a-z]+| +$)", L"", true)
-    (L"  +", L" ");
+    (substitution_set()
+     (L"(^[^-0-9a-z]+| +$)", L"", true)
+     (L"  +", L" "));
 }
@@ -31,6 +31,9 @@ public:
 
   // Configurable parameters container:
   static options settings;
+
+  // Letters of the language alphabet:
+  static const wchar_t* const alphabet;
 };
 
 #endif
@@ -18,16 +18,12 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
-#include <boost/assign.hpp>
-
 #include "Spanish.hpp"
 
 #include "config.hpp"
-#include "strcvt.hpp"
 #include "espeak.hpp"
 
 using namespace std;
-using namespace boost::assign;
 
 
 // Static data:
@@ -45,6 +41,8 @@ language_description::options Spanish::settings =
     .caps_factor = 1.2
   };
 
+const wchar_t* const Spanish::alphabet = L"a-zñáéíóúü";
+
 static const wchar_t* criterion =
   L"[¿¡]|"
   L"[ai]rán|"
@@ -113,109 +111,118 @@ static const wchar_t* criterion =
   L")\\B";
 
 
+// Punctuations pronunciation:
+static const wchar_t* const punctuation_names[punctuations::count] =
+  {
+    L" Exclamación ",
+    L" Apostrofo ",
+    L" Interrogación ",
+    L" Coma ",
+    L" Punto ",
+    L" Punto y coma ",
+    L" Dos puntos ",
+    L" Guión-Menos ",
+    L" Arroba ",
+    L" Signo de número ",
+    L" Signo de dólar ",
+    L" Por ciento ",
+    L" Acento circunflejo ",
+    L" y comercial ",
+    L" Asterísco ",
+    L" Guión Bajo ",
+    L" Abrir paréntesis ",
+    L" Cerrar paréntesis ",
+    L" Más ",
+    L" Igual ",
+    L" Abrir corchete ",
+    L" Cerrar corchete ",
+    L" Abrir llave ",
+    L" Cerra llave ",
+    L" barra invertida ",
+    L" línea vertical ",
+    L" Comillas ",
+    L" Barra ",
+    L" acento grave ",
+    L" tilde ",
+    L" Menor que ",
+    L" Mayor que "
+  };
+
+// Letters dictionary:
+static const language_description::dictionary_item letters[] =
+  {
+    { L"á", L"a acento agudo" },
+    { L"é", L"e acento agudo" },
+    { L"í", L"i acento agudo" },
+    { L"ñ", L"n tilde" },
+    { L"ó", L"o acento agudo" },
+    { L"ú", L"u acento agudo" },
+    { L"Ñ", L"n tilde" },
+    { L"dollar", L"SignoDeDólar" },
+    { L"pound", L"SignoDeNúmero" },
+    { L"at", L"arroba" },
+    { L"exclamation", L"Exclamación" },
+    { L"slash", L"barra" },
+    { L"percent", L"PorCiento" },
+    { L"caret", L"AcentoCircunflejo" },
+    { L"ampersand", L"yComercial" },
+    { L"star", L"asterísco" },
+    { L"dash", L"GuiónMenos" },
+    { L"underscore", L"GuiónBajo" },
+    { L"plus", L"Más" },
+    { L"equals", L"Igual" },
+    { L"backslash", L"barraInvertida" },
+    { L"pipe", L"líneaVertical" },
+    { L"period", L"punto" },
+    { L"comma", L"coma" },
+    { L"semi", L"puntoYcoma" },
+    { L"colon", L"dosPuntos" },
+    { L"apostrophe", L"apostrofo" },
+    { L"quotes", L"Comillas" },
+    { L"question mark", L"Interrogación" },
+    { L"backquote", L"acento" },
+    { L"left paren", L"Abrir paréntesis" },
+    { L"right paren", L"Cerrar paréntesis" },
+    { L"left bracket", L"Abrir corchete" },
+    { L"right bracket", L"Cerrar corchete" },
+    { L"left brace", L"Abrir llave" },
+    { L"right brace", L"Cerra llave" },
+    { L"less than", L"Menor que" },
+    { L"greater than", L"Mayor que" },
+    { L"space", L"espacio" },
+    { L"tab", L"tabulación" },
+    { L"newline", L"alimentaciónDeLínea" },
+    { L"¿", L"interrogaciónInversa" },
+    { L"¡", L"inversoDeExclamación" },
+    { L"dot", L"punto" },
+    { NULL, NULL }
+  };
+
+
 // Object construction:
 
 Spanish::Spanish(void):
-  language_description(lang_id::es, settings, L"a-zñáéíóúü", criterion)
+  language_description(lang_id::es, settings, alphabet, criterion)
 {
-  // Punctuations pronunciation:
-  punctuations = list_of
-    (L" Exclamación ")
-    (L" Apostrofo ")
-    (L" Interrogación ")
-    (L" Coma ")
-    (L" Punto ")
-    (L" Punto y coma ")
-    (L" Dos puntos ")
-    (L" Guión-Menos ")
-    (L" Arroba ")
-    (L" Signo de número ")
-    (L" Signo de dólar ")
-    (L" Por ciento ")
-    (L" Acento circunflejo ")
-    (L" y comercial ")
-    (L" Asterísco ")
-    (L" Guión Bajo ")
-    (L" Abrir paréntesis ")
-    (L" Cerrar paréntesis ")
-    (L" Más ")
-    (L" Igual ")
-    (L" Abrir corchete ")
-    (L" Cerrar corchete ")
-    (L" Abrir llave ")
-    (L" Cerra llave ")
-    (L" barra invertida ")
-    (L" línea vertical ")
-    (L" Comillas ")
-    (L" Barra ")
-    (L" acento grave ")
-    (L" tilde ")
-    (L" Menor que ")
-    (L" Mayor que ")
-    .convert_to_container< vector<const wchar_t*> >();
-
   // Letters dictionary:
-  dictionary = map_list_of
-    (L"á", L"a acento agudo")
-    (L"é", L"e acento agudo")
-    (L"í", L"i acento agudo")
-    (L"ñ", L"n tilde")
-    (L"ó", L"o acento agudo")
-    (L"ú", L"u acento agudo")
-    (L"Ñ", L"n tilde")
-    (L"dollar", L"SignoDeDólar")
-    (L"pound", L"SignoDeNúmero")
-    (L"at", L"arroba")
-    (L"exclamation", L"Exclamación")
-    (L"slash", L"barra")
-    (L"percent", L"PorCiento")
-    (L"caret", L"AcentoCircunflejo")
-    (L"ampersand", L"yComercial")
-    (L"star", L"asterísco")
-    (L"dash", L"GuiónMenos")
-    (L"underscore", L"GuiónBajo")
-    (L"plus", L"Más")
-    (L"equals", L"Igual")
-    (L"backslash", L"barraInvertida")
-    (L"pipe", L"líneaVertical")
-    (L"period", L"punto")
-    (L"comma", L"coma")
-    (L"semi", L"puntoYcoma")
-    (L"colon", L"dosPuntos")
-    (L"apostrophe", L"apostrofo")
-    (L"quotes", L"Comillas")
-    (L"question mark", L"Interrogación")
-    (L"backquote", L"acento")
-    (L"left paren", L"Abrir paréntesis")
-    (L"right paren", L"Cerrar paréntesis")
-    (L"left bracket", L"Abrir corchete")
-    (L"right bracket", L"Cerrar corchete")
-    (L"left brace", L"Abrir llave")
-    (L"right brace", L"Cerra llave")
-    (L"less than", L"Menor que")
-    (L"greater than", L"Mayor que")
-    (L"space", L"espacio")
-    (L"tab", L"tabulación")
-    (L"newline", L"alimentaciónDeLínea")
-    (L"¿", L"interrogaciónInversa")
-    (L"¡", L"inversoDeExclamación")
-    (L"dot", L"punto")
-
-    // Language name:
-    (intern_string(id).c_str(), L"Español")
-    .convert_to_container< map<const wstring, const wchar_t*> >();
+  dictionary = letters;
+
+  // Language name:
+  language_name = L"Español";
 
   // Text filtering chain:
   filter_chain.setup()
     (L"\\.,", L" punto coma ")
     (L"\\.{3}", L" punto punto punto ")
     (L"\\.{2}", L" punto punto ")
-    (L"([a-záéíñóú])\\.([a-záéíñóú])", L"$1 punto $2", true)
-    (L"([0-9])\\.([0-9])", L"$1punto$2")
+    (substitution_set()
+     (L"([a-záéíñóú])\\.([a-záéíñóú])", L"$1 punto $2", true)
+     (L"([0-9])\\.([0-9])", L"$1punto$2"))
     (L"[\\+-]?[0-9]+|_", L" $& ")
-    (punctuations)
+    (punctuation_names)
     (L"(^|[^'])\\<[bcdfghj-np-tvwxzñ]+\\>([^']|$)", spell(this), true)
     (L"[^\\.,!\\?';\\:0-9a-záéíñóú]", L" ", true)
-    (L"(^[^-0-9a-záéíñóú]+| +$)", L"", true)
-    (L"  +", L" ");
+    (substitution_set()
+     (L"(^[^-0-9a-záéíñóú]+| +$)", L"", true)
+     (L"  +", L" "));
 }
@@ -336,19 +336,24 @@ audioplayer::open_stream(void)
 void
 audioplayer::close_stream(void)
 {
-  boost::mutex::scoped_lock lock(access);
-  if (stream)
-    {
-      if (stream->isOpen())
-        stream->close();
-    }
-  else if (paStream)
-    {
-      pa_simple_free(paStream);
-      paStream = NULL;
-    }
-  running = false;
-  complete.notify_all();
+  {
+    boost::mutex::scoped_lock lock(access);
+    if (stream)
+      {
+        if (stream->isOpen())
+          stream->close();
+      }
+    else if (paStream)
+      {
+        pa_simple_free(paStream);
+        paStream = NULL;
+      }
+    running = false;
+    complete.notify_all();
+  }
+
+  // Completion is reported outside the lock, since the consumer
+  // checks the playing state while holding its own one:
   notify_completion();
 }
 
@@ -0,0 +1,124 @@
+// channel.cpp -- Buffered line oriented communication implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "channel.hpp"
+
+using namespace std;
+
+
+// Construct / destroy:
+
+channel::channel(int input_fd, int output_fd):
+  in(input_fd),
+  out(output_fd),
+  input(block_size),
+  first(0),
+  last(0),
+  scanned(0)
+{
+}
+
+channel::~channel(void)
+{
+  flush();
+}
+
+
+// Public methods:
+
+bool
+channel::get_line(line& result)
+{
+  while (!ready())
+    {
+      flush();
+      if (!receive())
+        return false;
+    }
+  const char* start = input.data() + first;
+  const char* end = input.data() + scanned;
+  result = line(start, end);
+  first = scanned = scanned + 1;
+  return true;
+}
+
+bool
+channel::ready(void)
+{
+  const char* end = static_cast<const char*>(memchr(input.data() + scanned, '\n', last - scanned));
+  scanned = end ? (end - input.data()) : last;
+  return end;
+}
+
+bool
+channel::receive(void)
+{
+  // Move the rest to the beginning and provide room for new data:
+  if (first)
+    {
+      memmove(input.data(), input.data() + first, last - first);
+      last -= first;
+      scanned -= first;
+      first = 0;
+    }
+  if (last == input.size())
+    input.resize(input.size() * 2);
+  ssize_t got;
+  do got = read(in, input.data() + last, input.size() - last);
+  while ((got < 0) && (errno == EINTR));
+  if (got <= 0)
+    return false;
+  last += got;
+  return true;
+}
+
+void
+channel::put_line(const string& s)
+{
+  boost::mutex::scoped_lock lock(output_access);
+  output += s;
+  output += '\n';
+}
+
+bool
+channel::flush(void)
+{
+  boost::mutex::scoped_lock lock(output_access);
+  size_t sent = 0;
+  while (sent < output.length())
+    {
+      ssize_t written = write(out, output.data() + sent, output.length() - sent);
+      if (written < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          output.clear();
+          return false;
+        }
+      sent += written;
+    }
+  output.clear();
+  return true;
+}
@@ -0,0 +1,90 @@
+// channel.hpp -- Buffered line oriented communication interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The channel class provides line oriented communication with the client
+// over a pair of raw file descriptors. Input is read by large blocks
+// and lines are handed out as ranges in the input buffer, so they are
+// not copied. Replies are collected in the output buffer and sent
+// out by one write when flushed. Pending replies are flushed
+// automatically before waiting for more input, so a burst of commands
+// is answered at once. Replies may be put from several threads.
+// A channel may also be used without blocking on input: receive()
+// reads only once, and ready() tells whether a complete line
+// is available already.
+
+#ifndef MULTISPEECH_CHANNEL_HPP
+#define MULTISPEECH_CHANNEL_HPP
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/range.hpp>
+#include <boost/thread/mutex.hpp>
+
+class channel
+{
+public:
+  // Input line representation:
+  typedef boost::iterator_range<const char*> line;
+
+  // Construct / destroy:
+  explicit channel(int input = STDIN_FILENO, int output = STDOUT_FILENO);
+  ~channel(void);
+
+  // Get next input line without terminating line break. The result
+  // is valid until next call. Returns false when input is exhausted
+  // or broken. Incomplete last line is not returned.
+  bool get_line(line& result);
+
+  // Check if a complete line is received already:
+  bool ready(void);
+
+  // Read available input once. Returns false when input
+  // is exhausted or broken:
+  bool receive(void);
+
+  // Put reply line into the output buffer. Line break is appended:
+  void put_line(const std::string& s);
+
+  // Send out all buffered replies. Returns false on failure:
+  bool flush(void);
+
+private:
+  // File descriptors:
+  const int in, out;
+
+  // Input buffer and unconsumed data boundaries in it. Line break
+  // is not present before the scanned position, unless it stands
+  // exactly there:
+  std::vector<char> input;
+  std::size_t first, last, scanned;
+
+  // Buffered output:
+  std::string output;
+  boost::mutex output_access;
+
+  // Initial input buffer size. It grows as needed for long lines:
+  static const std::size_t block_size = 0x10000;
+};
+
+#endif
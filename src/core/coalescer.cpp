@@ -0,0 +1,115 @@
+// coalescer.cpp -- Interactive speech tasks coalescing implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <utility>
+
+#include <boost/thread/thread_time.hpp>
+
+#include "coalescer.hpp"
+
+using namespace boost;
+using namespace boost::posix_time;
+
+
+// Static data definition:
+unsigned int coalescer::window = 50;
+
+
+// Construct / destroy:
+
+coalescer::coalescer(executor* host):
+  target(host),
+  launched(min_date_time),
+  cancellations(0),
+  alive(true),
+  service(boost::ref(*this))
+{
+}
+
+coalescer::~coalescer(void)
+{
+  {
+    boost::mutex::scoped_lock lock(access);
+    alive = false;
+    pending.reset();
+    event.notify_one();
+  }
+  service.join();
+}
+
+
+// Public methods:
+
+void
+coalescer::submit(const speech_task& task)
+{
+  boost::mutex::scoped_lock lock(access);
+  pending = task;
+  event.notify_one();
+}
+
+void
+coalescer::cancel(void)
+{
+  {
+    boost::mutex::scoped_lock lock(access);
+    pending.reset();
+    cancellations++;
+  }
+
+  // Wait for the launch in progress if any:
+  boost::mutex::scoped_lock lock(launching);
+}
+
+void
+coalescer::operator()(void)
+{
+  boost::mutex::scoped_lock lock(access);
+  while (alive)
+    if (!pending)
+      event.wait(lock);
+    else if (get_system_time() < launched + milliseconds(window))
+      event.timed_wait(lock, launched + milliseconds(window));
+    else
+      {
+        speech_task task(std::move(*pending));
+        unsigned long epoch = cancellations;
+        pending.reset();
+        launched = get_system_time();
+        lock.unlock();
+        launch(task, epoch);
+        lock.lock();
+      }
+}
+
+
+// Private methods:
+
+void
+coalescer::launch(const speech_task& task, unsigned long epoch)
+{
+  boost::mutex::scoped_lock lock(launching);
+  {
+    boost::mutex::scoped_lock check(access);
+    if (epoch != cancellations)
+      return;
+  }
+  target->launch(task);
+}
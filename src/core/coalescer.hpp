@@ -0,0 +1,102 @@
+// coalescer.hpp -- Interactive speech tasks coalescing interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The coalescer class stands in front of the actual speech task
+// executor and protects it from the flood of interactive tasks,
+// such as key echo produced when a key is held down. A task coming
+// after a quiet period is passed to the executor immediately.
+// Tasks coming within the coalescing window after that are not
+// started at once. Only the latest of them is kept pending and passed
+// to the executor when the window expires, so superseded ones
+// are dropped before any synthesis is started for them. Thus it is
+// a throttle rather than a debounce: a steady flood produces one task
+// per window, and a single key is never delayed.
+
+// Tasks are passed to the executor by the coalescer thread without
+// holding the lock, so submission never waits for a slow executor.
+// A task dropped by cancel() is never launched after cancel() returns.
+
+#ifndef MULTISPEECH_COALESCER_HPP
+#define MULTISPEECH_COALESCER_HPP
+
+#include <boost/optional.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "loudspeaker.hpp"
+
+class coalescer
+{
+public:
+  // Actual executor interface:
+  class executor
+  {
+  public:
+    virtual void launch(const speech_task& task) = 0;
+  };
+
+  // Construct / destroy:
+  explicit coalescer(executor* host);
+  ~coalescer(void);
+
+  // Pass task to the executor now or later:
+  void submit(const speech_task& task);
+
+  // Drop pending task if any:
+  void cancel(void);
+
+  // The thread execution loop.
+  void operator()(void);
+
+  // Configurable parameters:
+  static unsigned int window; // in milliseconds
+
+private:
+  // Task executor:
+  executor* target;
+
+  // Task waiting for the window expiration:
+  boost::optional<speech_task> pending;
+
+  // When the last task was passed to the executor:
+  boost::system_time launched;
+
+  // Cancellations counter. A task taken for launching
+  // is dropped if a cancellation comes before it is launched:
+  unsigned long cancellations;
+
+  // Clearing this flag causes execution thread termination.
+  bool alive;
+
+  // Synchronization means:
+  boost::mutex access, launching;
+  boost::condition event;
+
+  // Thread handler.
+  boost::thread service;
+
+  // Pass task taken after specified number of cancellations
+  // to the executor unless it was cancelled since then:
+  void launch(const speech_task& task, unsigned long epoch);
+};
+
+#endif
@@ -19,6 +19,7 @@
 */
 
 #include <cstdlib>
+#include <functional>
 #include <string>
 #include <sstream>
 
@@ -31,8 +32,12 @@
 
 #include "audioplayer.hpp"
 #include "file_player.hpp"
+#include "sound_cache.hpp"
+#include "text_cache.hpp"
 #include "tone_generator.hpp"
 #include "loudspeaker.hpp"
+#include "sound_manager.hpp"
+#include "coalescer.hpp"
 
 #include "speech_engine.hpp"
 #include "speech_server.hpp"
@@ -92,6 +97,8 @@
 #define ACCEPT_EXPLICIT_LANGUAGE "accept_explicit_language"
 #define IGNORE_UNKNOWN_VOICE "ignore_unknown_voice"
 #define INDEX_MARKS "index_marks"
+#define STREAM_THRESHOLD "stream_threshold"
+#define SOCKET "socket"
 #define GENERAL_VOLUME "general_volume"
 #define LATENCY "latency"
 #define ASYNC_OPERATION "async_operation"
@@ -99,6 +106,12 @@
 #define LANG_PREF "language"
 #define FALLBACK "fallback"
 #define SPEAK_NUMBERS "speak_numbers"
+#define CACHE "cache"
+#define CHUNK_SIZE "chunk_size"
+#define PRELOAD "preload"
+#define MESSAGE "message"
+#define TEXT "text"
+#define COALESCING_WINDOW "coalescing_window"
 
 // Configuration sections names:
 #define FRONTEND "frontend"
@@ -107,6 +120,7 @@
 #define SOUNDS "sounds"
 #define TONES "tones"
 #define SPEECH "speech"
+#define SCHEDULING "scheduling"
 
 // Supported languages:
 #define EN "en"
@@ -131,6 +145,7 @@
 #define VOLUME(section, component) FLOAT(section, LOUDNESS, component::relative_volume, 1.0)
 #define ASYNCHRONOUS(section, component) BOOLEAN(section, "asynchronous", component::asynchronous, true)
 #define SAMPLING(section, component, default) UINT(section, "sampling", component::sampling, default)
+#define URGENCY(name, level, default) OPTION(SCHEDULING, name, sound_manager::policy, sound_manager::scheduling[sound_manager::level], sound_manager::default)
 #define EXECUTABLE(backend, component) STRING(backend, "executable", component::executable, component::name)
 #define LEXICON(backend, component) STRING(backend, "lexicon", component::lexicon, component::lexicon_default_path)
 
@@ -188,6 +203,7 @@ namespace lang_id
 // Parsing and applying configuration options
 
 string configuration::stage;
+string configuration::digest;
 
 configuration::configuration(int argc, char* argv[], bool is_spd_backend):
   spd_backend(is_spd_backend)
@@ -242,7 +258,10 @@ configuration::configuration(int argc, char* argv[], bool is_spd_backend):
   if (!info.str().empty())
     throw info.str();
   if (option_value.count("debug"))
-    speech_server::debug = true;
+    {
+      speech_server::debug = true;
+      sources = "--debug\n";
+    }
 
   // Declare configuration options:
   conf.add_options()
@@ -251,6 +270,8 @@ configuration::configuration(int argc, char* argv[], bool is_spd_backend):
     STRING(FRONTEND, CHARSET, speech_server::frontend_charset, "")
     BOOLEAN(FRONTEND, NATIVE_VOICES, speech_server::support_native_voices, true)
     BOOLEAN(FRONTEND, DTK_VOICES, speech_server::support_dtk_voices, false)
+    UINT(FRONTEND, COALESCING_WINDOW, coalescer::window, 50)
+    STRING(FRONTEND, SOCKET, speech_server::frontend_socket, "")
 
     // General audio options:
     DEVICE(AUDIO, audioplayer)
@@ -263,6 +284,8 @@ configuration::configuration(int argc, char* argv[], bool is_spd_backend):
     DEVICE(SOUNDS, file_player)
     VOLUME(SOUNDS, file_player)
     ASYNCHRONOUS(SOUNDS, file_player)
+    UINT(SOUNDS, CACHE, sound_cache::capacity, 8192)
+    STRING(SOUNDS, PRELOAD, sound_cache::preload_path, "")
 
     // tones producing section:
     DEVICE(TONES, tone_generator)
@@ -270,11 +293,17 @@ configuration::configuration(int argc, char* argv[], bool is_spd_backend):
     ASYNCHRONOUS(TONES, tone_generator)
     SAMPLING(TONES, tone_generator, 44100)
 
+    // Queued jobs scheduling policies:
+    URGENCY(MESSAGE, message, preempt)
+    URGENCY(TEXT, text, queue)
+
     // General speech control options:
     DEVICE(SPEECH, loudspeaker)
     VOLUME(SPEECH, loudspeaker)
     STRING(SPEECH, LANG_PREF, polyglot::language_preference, "")
     STRING(SPEECH, FALLBACK, polyglot::fallback_language, lang_id::en)
+    UINT(SPEECH, CACHE, text_cache::capacity, 256)
+    UINT(SPEECH, CHUNK_SIZE, polyglot::chunk_size, 0)
 
     // Language sections:
     LANGUAGE(EN, English)
@@ -344,7 +373,9 @@ configuration::configuration(int argc, char* argv[], bool is_spd_backend):
     BOOLEAN(SPD, USE_VOICE_LANGUAGE, speech_server::spd_use_voice_language, true)
     BOOLEAN(SPD, ACCEPT_EXPLICIT_LANGUAGE, speech_server::spd_accept_explicit_language, true)
     BOOLEAN(SPD, IGNORE_UNKNOWN_VOICE, speech_server::spd_ignore_unknown_voice, false)
-    BOOLEAN(SPD, INDEX_MARKS, speech_server::spd_support_index_marks, true);
+    BOOLEAN(SPD, INDEX_MARKS, speech_server::spd_support_index_marks, true)
+    UINT(SPD, STREAM_THRESHOLD, speech_server::spd_stream_threshold, 0)
+    STRING(SPD, SOCKET, speech_server::spd_socket, "");
 
   // Parse config files and store values
   path extra_conf;
@@ -385,6 +416,10 @@ configuration::configuration(int argc, char* argv[], bool is_spd_backend):
   if (noconf && !spd_backend)
     throw configuration::error("No configuration files found");
   notify(option_value);
+
+  ostringstream fingerprint;
+  fingerprint << hex << std::hash<string>()(sources);
+  digest = fingerprint.str();
 }
 
 
@@ -402,7 +437,11 @@ void
 configuration::read(const path& config_file, const options_description& conf, variables_map& option_value)
 {
   boost::filesystem::ifstream source(config_file);
+  ostringstream text;
+  text << source.rdbuf();
+  sources += config_file.generic_string() + '\n' + text.str() + '\n';
+  istringstream content(text.str());
   stage = " in " + config_file.generic_string();
-  store(parse_config_file(source, conf), option_value);
+  store(parse_config_file(content, conf), option_value);
   stage.erase();
 }
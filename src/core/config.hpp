@@ -58,6 +58,11 @@ public:
   // What we are parsing now:
   static std::string stage;
 
+  // Configuration fingerprint made up of the configuration files
+  // and command line options. Daemon clients check by it whether
+  // the daemon has been started with the same configuration:
+  static std::string digest;
+
   // Error signaling:
   class error: public std::logic_error
   {
@@ -73,6 +78,10 @@ private:
 
   // Set when called as Speech Dispatcher backend:
   bool spd_backend;
+
+  // Configuration files contents read so far and the options
+  // taken from command line:
+  std::string sources;
 };
 
 #endif
@@ -73,8 +73,9 @@ espeak::espeak(const char* lang):
 
 // Making up voice parameters:
 void
-espeak::voicify(double rate, double pitch)
+espeak::voicify(map<const char*, string>& macros,
+                double rate, double pitch) const
 {
-  format_macros[pitch_macro] = lexical_cast<string>((atan((pitch * pitch) - 1) * 50.0 / M_2_PI) + 50.0);
-  format_macros[rate_macro] = lexical_cast<string>(rate * 170.0);
+  macros[pitch_macro] = lexical_cast<string>((atan((pitch * pitch) - 1) * 50.0 / M_2_PI) + 50.0);
+  macros[rate_macro] = lexical_cast<string>(rate * 170.0);
 }
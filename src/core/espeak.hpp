@@ -55,7 +55,8 @@ public:
 
 private:
   // Make up voice parameters for backend:
-  void voicify(double rate, double pitch = 1.0);
+  void voicify(std::map<const char*, std::string>& macros,
+               double rate, double pitch = 1.0) const;
 };
 
 #endif
@@ -27,11 +27,19 @@
 // void execute(const task_description& task) -- to start task execution;
 // void abort(void) -- to stop currently executed task;
 // bool busy(void) -- to indicate execution state.
+//
+// Tasks are started and aborted by the execution thread outside
+// of the queue lock, so submitting and cancelling never wait
+// for the actual task execution control. Each cancellation bumps
+// the generation counter. When the counter has changed while a task
+// was being started, that task is considered stale and is aborted
+// as soon as it starts.
 
 #ifndef MULTISPEECH_EXEC_QUEUE_HPP
 #define MULTISPEECH_EXEC_QUEUE_HPP
 
 #include <queue>
+#include <utility>
 
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -45,6 +53,8 @@ protected:
   exec_queue(void):
     alive(true),
     discard(false),
+    executing(false),
+    generation(0),
     service(boost::ref(*this))
   {
   }
@@ -59,8 +69,15 @@ protected:
     service.join();
   }
 
-  // Internal events control means:
-  boost::condition event;
+  // Wake up the execution thread when the running task completes.
+  // The queue lock is taken, so the wakeup cannot slip in between
+  // the busy() check and the wait. Must not be called while holding
+  // any lock taken by busy().
+  void task_completed(void)
+  {
+    boost::mutex::scoped_lock lock(access);
+    event.notify_one();
+  }
 
 public:
   // Run or queue a new task:
@@ -78,7 +95,8 @@ public:
   {
     boost::mutex::scoped_lock lock(access);
     clear();
-    if (busy())
+    generation++;
+    if (executing || busy())
       {
         discard = true;
         event.notify_one();
@@ -89,7 +107,7 @@ public:
   bool done(void)
   {
     boost::mutex::scoped_lock lock(access);
-    return this->empty() && !busy();
+    return this->empty() && !executing && !busy();
   }
 
   // The thread execution loop.
@@ -98,15 +116,27 @@ public:
     boost::mutex::scoped_lock lock(access);
     while (alive)
       {
-        discard = false;
         while (alive && (this->empty() || busy()) && !discard)
           event.wait(lock);
         if (discard)
-          abort();
-        if (!this->empty())
           {
-            execute(this->front());
+            discard = false;
+            lock.unlock();
+            abort();
+            lock.lock();
+          }
+        else if (alive && !this->empty())
+          {
+            unsigned long started = generation;
+            task_description task(std::move(this->front()));
             this->pop();
+            executing = true;
+            lock.unlock();
+            execute(task);
+            lock.lock();
+            executing = false;
+            if (generation != started)
+              discard = true;
           }
       }
   }
@@ -118,8 +148,15 @@ private:
   // Discard current job along with the waiting queue:
   bool discard;
 
+  // Set while a task is being started:
+  bool executing;
+
+  // Cancellations counter:
+  unsigned long generation;
+
   // Exclusive data access control means.
   boost::mutex access;
+  boost::condition event;
 
   // Thread handler.
   boost::thread service;
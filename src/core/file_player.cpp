@@ -18,6 +18,8 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+#include <algorithm>
+
 #include "file_player.hpp"
 
 #include "audioplayer.hpp"
@@ -46,7 +48,8 @@ sound_task::sound_task(const path& sound_file, float sound_volume):
 
 file_player::file_player(condition& completion_event_consumer):
   soundfile(device.empty() ? audioplayer::device : device, "sounds"),
-  host(completion_event_consumer)
+  host(completion_event_consumer),
+  position(0)
 {
 }
 
@@ -76,20 +79,49 @@ file_player::active(void)
 
 // Private methods:
 
+unsigned int
+file_player::source_read(float* buffer, unsigned int nframes)
+{
+  if (!clip)
+    return soundfile::source_read(buffer, nframes);
+  unsigned int obtained = min(nframes, clip->frames() - position);
+  copy(clip->samples.begin() + position * clip->channels,
+       clip->samples.begin() + (position + obtained) * clip->channels,
+       buffer);
+  position += obtained;
+  return obtained;
+}
+
+void
+file_player::source_release(void)
+{
+  clip.reset();
+  soundfile::source_release();
+}
+
 void
 file_player::notify_completion(void)
 {
-  event.notify_one();
+  task_completed();
   host.notify_one();
 }
 
 void
 file_player::execute(const sound_task& sound)
 {
-  SF_INFO::format = autodetect;
-  source = sf_open(sound.file.generic_string().c_str(), SFM_READ, this);
-  if (source)
-    start_playback(sound.volume * relative_volume, samplerate, channels);
+  clip = sound_cache::lookup(sound.file);
+  if (clip)
+    {
+      position = 0;
+      start_playback(sound.volume * relative_volume, clip->rate, clip->channels);
+    }
+  else
+    {
+      SF_INFO::format = autodetect;
+      source = sf_open(sound.file.generic_string().c_str(), SFM_READ, this);
+      if (source)
+        start_playback(sound.volume * relative_volume, samplerate, channels);
+    }
 }
 
 void
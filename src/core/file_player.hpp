@@ -28,9 +28,11 @@
 #include <string>
 
 #include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/condition.hpp>
 
 #include "soundfile.hpp"
+#include "sound_cache.hpp"
 #include "exec_queue.hpp"
 
 // Typical task is represented by sound file specification
@@ -44,8 +46,8 @@ public:
 
 private:
   // Properties accessible only for actual executor:
-  const boost::filesystem::path file;
-  const float volume;
+  boost::filesystem::path file;
+  float volume;
 
   friend class file_player;
 };
@@ -79,7 +81,13 @@ private:
   // Playback completion event consumer:
   boost::condition& host;
 
-  // Method required by audioplayer:
+  // Currently played sound when it is taken from the cache:
+  boost::shared_ptr<const sound_cache::clip> clip;
+  unsigned int position;
+
+  // Methods required by audioplayer:
+  unsigned int source_read(float* buffer, unsigned int nframes);
+  void source_release(void);
   void notify_completion(void);
 
   // Methods required by exec_queue:
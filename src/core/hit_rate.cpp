@@ -0,0 +1,72 @@
+// hit_rate.cpp -- Usage statistics reporting implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <iostream>
+#include <sstream>
+
+#include <bobcat/syslogstream>
+
+#include "hit_rate.hpp"
+
+#include "speech_server.hpp"
+
+using namespace std;
+using namespace FBB;
+
+
+// Object construction:
+
+hit_rate::hit_rate(const string& subject,
+                   const char* hits_name,
+                   const char* requests_name):
+  title(subject),
+  hits_label(hits_name),
+  requests_label(requests_name),
+  requests(0),
+  hits(0)
+{
+}
+
+
+// Public methods:
+
+bool
+hit_rate::count(bool hit)
+{
+  if (hit)
+    hits++;
+  return !(++requests % report_interval) && speech_server::debug;
+}
+
+void
+hit_rate::report(const string& details) const
+{
+  unsigned long total = requests;
+  if (!total)
+    return;
+  ostringstream message;
+  message << title << ": " << (hits * 100 / total) << "% "
+          << hits_label << " of " << total << ' ' << requests_label;
+  if (!details.empty())
+    message << ", " << details;
+  speech_server::log << SyslogStream::debug << message.str() << endl;
+  if (speech_server::verbose)
+    cerr << message.str() << endl;
+}
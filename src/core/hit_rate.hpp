@@ -0,0 +1,58 @@
+// hit_rate.hpp -- Usage statistics reporting interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The hit_rate class counts requests and hits, such as cache hits,
+// and logs their ratio every so many requests in debug mode.
+// The counters are atomic, so requests may be counted
+// from several threads without any locking.
+
+#ifndef MULTISPEECH_HIT_RATE_HPP
+#define MULTISPEECH_HIT_RATE_HPP
+
+#include <atomic>
+#include <string>
+
+class hit_rate
+{
+public:
+  // The subject and the names of counted events
+  // are used in the log message:
+  hit_rate(const std::string& subject,
+           const char* hits_name = "hits",
+           const char* requests_name = "requests");
+
+  // Count a request. Returns true when the statistics
+  // is to be reported:
+  bool count(bool hit);
+
+  // Log the statistics. Optional details are appended to the message:
+  void report(const std::string& details = std::string()) const;
+
+private:
+  const std::string title;
+  const char* const hits_label;
+  const char* const requests_label;
+  std::atomic<unsigned long> requests, hits;
+
+  // Statistics is reported every so many requests:
+  static const unsigned long report_interval = 1000;
+};
+
+#endif
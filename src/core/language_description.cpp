@@ -18,16 +18,38 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+#include <cwchar>
+#include <cwctype>
 #include <map>
 
+#include <boost/thread/mutex.hpp>
+
 #include "language_description.hpp"
 
+#include "strcvt.hpp"
+
 using namespace std;
 using namespace boost;
 
 
-// Alphabets of all instantiated languages:
+// Alphabets of all registered languages:
 static map<const char*, const wchar_t*> alphabets;
+static boost::mutex alphabets_access;
+
+// Punctuation marking text division points. It is the same for all
+// supported languages. Inverted marks in Spanish and spaced marks
+// in French need no special care, since text is split only
+// at whitespace following these characters.
+static const wchar_t sentence_ends[] = L".!?\u2026";
+static const wchar_t clause_ends[] = L",;:\u2013\u2014";
+static const wchar_t closing_marks[] = L"\"')]}\u00bb\u201d\u2019";
+
+// Check if the character belongs to the set:
+static bool
+member(wchar_t c, const wchar_t* set)
+{
+  return c && wcschr(set, c);
+}
 
 
 // Construct / destroy:
@@ -38,15 +60,21 @@ language_description::language_description(const char* language_id,
                                            const wchar_t* language_detector):
   id(language_id),
   settings(language_settings),
+  dictionary(NULL),
+  language_name(NULL),
   patterns(language_detector),
   test(wstring(L"(?:\\P{al") +
        (language_settings.speak_numbers ? L"pha" : L"num") +
        L"}|[" + alphabet + L"])*",
-       regex::normal | regex::icase)
+       regex::normal | regex::icase),
+  letter(wstring(L"\\P{al") +
+         (language_settings.speak_numbers ? L"pha" : L"num") +
+         L"}|[" + alphabet + L"]",
+         regex::normal | regex::icase)
 {
   filter_chain.setup()
     (L"\\s+", L" ");
-  alphabets[id] = alphabet;
+  add_alphabet(id, alphabet);
 }
 
 language_description::~language_description(void)
@@ -56,33 +84,18 @@ language_description::~language_description(void)
 
 // General actions:
 
+void
+language_description::add_alphabet(const char* language_id, const wchar_t* alphabet)
+{
+  boost::mutex::scoped_lock lock(alphabets_access);
+  alphabets[language_id] = alphabet;
+}
+
 bool
-language_description::recognize(const wstring& s)
+language_description::recognize(const wstring& s) const
 {
-  if (detector.empty())
-    {
-      wstring others;
-      for (auto const& item : alphabets)
-        if (item.first != id)
-          others += item.second;
-      if (others.empty())
-        detector.assign(L".", regex::normal);
-      else
-        {
-          const wchar_t* latin = L"a-z";
-          wstring symbols;
-          if (alphabets[id][0] == L'a')
-            for (const wchar_t* s = alphabets[id] + 3; *s; s++)
-              if (others.find(*s) == string::npos)
-                symbols += *s;
-          if ((alphabets[id][0] == L'a') && (others.find(latin) == string::npos))
-            detector.assign(L"[" + symbols + latin + L"]", regex::normal | regex::icase);
-          else if (symbols.empty())
-            detector.assign(patterns, regex::normal | regex::icase);
-          else detector.assign(L"[" + symbols + L"]|" + patterns, regex::normal | regex::icase);
-        }
-    }
-  return regex_search(s, detector, match_default | match_any);
+  return (!marker.empty() && regex_search(s, marker, match_default | match_any)) ||
+    (!detector.empty() && regex_search(s, detector, match_default | match_any));
 }
 
 bool
@@ -91,17 +104,105 @@ language_description::foreign(const wstring& s)
   return !regex_match(s, test);
 }
 
-wstring
-language_description::filter(const wstring& s)
+bool
+language_description::identifies(wchar_t c) const
+{
+  return !marker.empty() && regex_match(&c, &c + 1, marker);
+}
+
+bool
+language_description::admits(wchar_t c) const
 {
-  return filter_chain.process(s);
+  return regex_match(&c, &c + 1, letter);
+}
+
+bool
+language_description::guess(const wstring& s) const
+{
+  return !detector.empty() && regex_search(s, detector, match_default | match_any);
 }
 
 wstring
+language_description::filter(const wstring& s, filter_context& context) const
+{
+  return filter_chain.process(s, context);
+}
+
+void
+language_description::prepare(void)
+{
+  setup_detectors();
+  compile_dictionary();
+}
+
+size_t
+language_description::split_point(const wstring& s, size_t start,
+                                  size_t limit) const
+{
+  if ((s.length() - start) <= limit)
+    return s.length();
+  size_t clause = 0, space = 0;
+  for (size_t i = start + limit; i > start; i--)
+    if (iswspace(s[i]))
+      {
+        size_t end = i;
+        while ((end > start) && member(s[end - 1], closing_marks))
+          end--;
+        if (end > start)
+          {
+            if (member(s[end - 1], sentence_ends))
+              return i;
+            if (!clause && member(s[end - 1], clause_ends))
+              clause = i;
+          }
+        if (!space)
+          space = i;
+      }
+  if (clause)
+    return clause;
+  if (space)
+    return space;
+
+  // A word longer than the limit is not broken:
+  for (size_t i = start + limit; i < s.length(); i++)
+    if (iswspace(s[i]))
+      return i;
+  return s.length();
+}
+
+unsigned int
+language_description::filter_passes(void) const
+{
+  return filter_chain.passes();
+}
+
+const wchar_t*
 language_description::translate(const wstring& s) const
 {
-  map<const wstring, const wchar_t*>::const_iterator item = dictionary.find(s);
-  return (item == dictionary.end()) ? wstring(L"") : item->second;
+  return translate(s.data(), s.length());
+}
+
+const wchar_t*
+language_description::translate(const wchar_t* s, size_t length) const
+{
+  if (slots.empty())
+    return NULL;
+  if ((length == 1) && (static_cast<unsigned int>(*s) < characters_range))
+    return characters[*s];
+  size_t mask = slots.size() - 1;
+  for (size_t slot = hash(s, length) & mask; slots[slot]; slot = (slot + 1) & mask)
+    {
+      const entry& item = entries[slots[slot] - 1];
+      if ((item.length == length) && !keys.compare(item.offset, length, s, length))
+        return item.translation;
+    }
+  return NULL;
+}
+
+const wchar_t*
+language_description::translate(wchar_t c) const
+{
+  return translate(&c, 1);
 }
 
 
@@ -115,15 +216,111 @@ language_description::spell::spell(language_description* owner):
 wstring
 language_description::spell::operator()(const iterator_range<wstring::const_iterator>& s)
 {
-  wstring result, item;
+  wstring result;
   for (wstring::const_iterator sptr = s.begin(); sptr != s.end(); ++sptr)
     {
-      item = language->translate(wstring(1, *sptr));
+      const wchar_t* item = language->translate(*sptr);
       if (!result.empty())
         result += L' ';
-      if (item.empty())
-        result += *sptr;
-      else result += item;
+      if (item)
+        result += item;
+      else result += *sptr;
     }
   return result;
 }
+
+
+// Private methods:
+
+void
+language_description::setup_detectors(void)
+{
+  const wchar_t* alphabet;
+  wstring others;
+  {
+    boost::mutex::scoped_lock lock(alphabets_access);
+    alphabet = alphabets[id];
+    for (auto const& item : alphabets)
+      if (item.first != id)
+        others += item.second;
+  }
+  if (others.empty())
+    marker.assign(L".", regex::normal);
+  else if (alphabet[0] != L'a')
+    {
+      // Any letter of an alphabet not based on Latin reveals
+      // the language unless another one uses the same alphabet:
+      if (others.find(alphabet) == wstring::npos)
+        marker.assign(L"[" + wstring(alphabet) + L"]", regex::normal | regex::icase);
+      detector.assign(patterns, regex::normal | regex::icase);
+    }
+  else
+    {
+      const wchar_t* latin = L"a-z";
+      wstring symbols;
+      for (const wchar_t* s = alphabet + 3; *s; s++)
+        if (others.find(*s) == wstring::npos)
+          symbols += *s;
+      if (others.find(latin) == wstring::npos)
+        marker.assign(L"[" + symbols + latin + L"]", regex::normal | regex::icase);
+      else
+        {
+          if (!symbols.empty())
+            marker.assign(L"[" + symbols + L"]", regex::normal | regex::icase);
+          detector.assign(patterns, regex::normal | regex::icase);
+        }
+    }
+}
+
+void
+language_description::compile_dictionary(void)
+{
+  characters.assign(characters_range, NULL);
+  size_t size = 2;
+  for (const dictionary_item* item = dictionary; item && item->word; item++)
+    size++;
+  while (size & (size - 1))
+    size &= size - 1;
+  slots.assign(size << 2, 0);
+  for (const dictionary_item* item = dictionary; item && item->word; item++)
+    add_word(item->word, wcslen(item->word), item->translation);
+  if (language_name)
+    {
+      intern_string name(id);
+      add_word(name.data(), name.length(), language_name);
+    }
+}
+
+void
+language_description::add_word(const wchar_t* word, size_t length, const wchar_t* translation)
+{
+  // Empty translations are never used.
+  if (!*translation || translate(word, length))
+    return;
+  if ((length == 1) && (static_cast<unsigned int>(*word) < characters_range))
+    characters[*word] = translation;
+  else
+    {
+      entry item;
+      item.offset = keys.length();
+      item.length = length;
+      item.translation = translation;
+      keys.append(word, length);
+      entries.push_back(item);
+      size_t mask = slots.size() - 1;
+      size_t slot = hash(word, length) & mask;
+      while (slots[slot])
+        slot = (slot + 1) & mask;
+      slots[slot] = entries.size();
+    }
+}
+
+size_t
+language_description::hash(const wchar_t* s, size_t length)
+{
+  // FNV-1a:
+  size_t result = 2166136261u;
+  for (size_t i = 0; i < length; i++)
+    result = (result ^ static_cast<size_t>(s[i])) * 16777619u;
+  return result;
+}
@@ -26,6 +26,7 @@
 #ifndef MULTISPEECH_LANGUAGE_DESCRIPTION_HPP
 #define MULTISPEECH_LANGUAGE_DESCRIPTION_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <map>
@@ -68,17 +69,64 @@ public:
   // Configured speech parameters:
   const options& settings;
 
+  // Register the alphabet of a language to be told apart from
+  // the others. Every language registers its own one when constructed,
+  // but all the languages in use should be registered before
+  // any of them is prepared, since language detectors depend
+  // on the whole set:
+  static void add_alphabet(const char* language_id, const wchar_t* alphabet);
+
   // Native language presence recognition:
-  bool recognize(const std::wstring& s);
+  bool recognize(const std::wstring& s) const;
 
   // Foreign language presence recognition:
   bool foreign(const std::wstring& s);
 
-  // text filtering:
-  std::wstring filter(const std::wstring& s);
+  // Single character tests for fast language detection.
+  // Returns true if the character alone reveals the language:
+  bool identifies(wchar_t c) const;
+
+  // Returns true if the character is not foreign for the language:
+  bool admits(wchar_t c) const;
 
-  // Translate by dictionary:
-  std::wstring translate(const std::wstring& s) const;
+  // Native language presence recognition by the word patterns only.
+  // Together with identifies() it gives the same result as recognize():
+  bool guess(const std::wstring& s) const;
+
+  // text filtering:
+  std::wstring filter(const std::wstring& s, filter_context& context) const;
+
+  // Find where a long text should be split to be spoken in parts.
+  // The part starting at specified position ends at the last
+  // sentence end within the limit or, if there is none, at the last
+  // clause end or word boundary. Returns the position following
+  // the part, that is the text length when the rest fits the limit.
+  std::size_t split_point(const std::wstring& s, std::size_t start,
+                          std::size_t limit) const;
+
+  // Number of passes over the text made by the filter:
+  unsigned int filter_passes(void) const;
+
+  // Set up language detectors and compile the dictionary.
+  // It must be done once before the language is used.
+  // Until then neither native language detection
+  // nor dictionary translation work:
+  void prepare(void);
+
+  // Translate by dictionary. The result points to the dictionary
+  // data, null pointer is returned when no translation is found:
+  const wchar_t* translate(const std::wstring& s) const;
+  const wchar_t* translate(const wchar_t* s, std::size_t length) const;
+  const wchar_t* translate(wchar_t c) const;
+
+  // Dictionary item. Dictionaries are static tables
+  // terminated by an item with null word:
+  class dictionary_item
+  {
+  public:
+    const wchar_t* word;
+    const wchar_t* translation;
+  };
 
 protected:
   // Spelling functor to expand abbreviations:
@@ -94,15 +142,52 @@ protected:
   };
 
   // These members are to be initialized in derived classes.
-  std::vector<const wchar_t*> punctuations;
-  std::map<const std::wstring, const wchar_t*> dictionary;
+  const dictionary_item* dictionary;
+  const wchar_t* language_name;
   text_filter filter_chain;
 
 private:
   // Language belonging criteria:
   const wchar_t* const patterns;
   const boost::wregex test;
+  const boost::wregex letter;
+
+  // Native language detectors: characters that can appear
+  // in this language only and specific word patterns.
+  // They are set up by prepare() with respect to the alphabets
+  // registered by then.
+  boost::wregex marker;
   boost::wregex detector;
+
+  // Set up native language detectors:
+  void setup_detectors(void);
+
+  // Compiled dictionary including the language name. Translations
+  // for single characters up to the Cyrillic block are indexed
+  // directly by character code. The rest of entries are placed
+  // in the hash table with linear probing. Keys are stored one after
+  // another in one string. When a word is listed more than once,
+  // the first translation is used.
+  class entry
+  {
+  public:
+    std::size_t offset;
+    std::size_t length;
+    const wchar_t* translation;
+  };
+
+  static const unsigned int characters_range = 0x500;
+  std::vector<const wchar_t*> characters;
+  std::vector<entry> entries;
+  std::vector<unsigned int> slots; // entry index + 1, 0 for empty slot
+  std::wstring keys;
+
+  // Compile the dictionary for fast lookup:
+  void compile_dictionary(void);
+  void add_word(const wchar_t* word, std::size_t length, const wchar_t* translation);
+
+  // Key hashing:
+  static std::size_t hash(const wchar_t* s, std::size_t length);
 };
 
 #endif
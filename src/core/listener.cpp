@@ -0,0 +1,429 @@
+// listener.cpp -- Daemon mode sessions control implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <bobcat/syslogstream>
+
+#include "listener.hpp"
+
+using namespace std;
+using namespace FBB;
+
+
+// Fill in socket address. Returns false if the path is too long:
+static bool
+socket_address(const string& path, sockaddr_un& address)
+{
+  if (path.length() >= sizeof(address.sun_path))
+    return false;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path.c_str());
+  return true;
+}
+
+// Write all the data. Returns false on failure:
+static bool
+transfer(int fd, const char* data, size_t length)
+{
+  while (length)
+    {
+      ssize_t written = write(fd, data, length);
+      if (written < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+      data += written;
+      length -= written;
+    }
+  return true;
+}
+
+
+// Close file descriptor if it is open:
+static void
+release_fd(int& fd)
+{
+  if (fd >= 0)
+    {
+      close(fd);
+      fd = -1;
+    }
+}
+
+
+// Construct / destroy:
+
+listener::listener(const string& socket_path, const string& fingerprint):
+  path(socket_path),
+  greeting(fingerprint),
+  socket_fd(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)),
+  linked(false)
+{
+  sockaddr_un address;
+  if (socket_fd < 0)
+    throw runtime_error(string("cannot create socket: ") + strerror(errno));
+  if (!socket_address(path, address))
+    {
+      close(socket_fd);
+      throw runtime_error("socket path is too long: " + path);
+    }
+  bool bound = !bind(socket_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  if (!bound && (errno == EADDRINUSE))
+    {
+      // The socket file may be left by a crashed daemon:
+      int probe = connect(path);
+      if (probe >= 0)
+        close(probe);
+      else if (!unlink(path.c_str()))
+        bound = !bind(socket_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+      else errno = EADDRINUSE;
+    }
+  if (!bound || (listen(socket_fd, SOMAXCONN) < 0))
+    {
+      string message("cannot listen on " + path + ": " + strerror(errno));
+      if (bound)
+        unlink(path.c_str());
+      close(socket_fd);
+      throw runtime_error(message);
+    }
+  linked = true;
+  finished[0] = finished[1] = -1;
+}
+
+listener::~listener(void)
+{
+  if (linked)
+    unlink(path.c_str());
+  release_fd(socket_fd);
+}
+
+
+// Public methods:
+
+bool
+listener::detach(void)
+{
+  pid_t pid = fork();
+  if (pid < 0)
+    throw runtime_error(string("cannot start daemon: ") + strerror(errno));
+  if (pid)
+    {
+      // The socket is served by the daemon from now on:
+      release_fd(socket_fd);
+      linked = false;
+      waitpid(pid, NULL, 0);
+      return false;
+    }
+
+  // The daemon is forked once more, so it is not left as a zombie
+  // when it quits before the process that started it:
+  setsid();
+  pid = fork();
+  if (pid)
+    _exit(pid < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+  int fd = open("/dev/null", O_RDWR);
+  if (fd >= 0)
+    {
+      dup2(fd, STDIN_FILENO);
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      if (fd > STDERR_FILENO)
+        close(fd);
+    }
+  return true;
+}
+
+void
+listener::run(host& server)
+{
+  typedef map< int, boost::shared_ptr<session> > session_map;
+  session_map sessions;
+  bool served = false;
+
+  // Client disconnection is detected by reading:
+  signal(SIGPIPE, SIG_IGN);
+
+  if (pipe2(finished, O_CLOEXEC) < 0)
+    throw runtime_error(string("daemon failure: ") + strerror(errno));
+  fcntl(socket_fd, F_SETFL, O_NONBLOCK);
+
+  while (!served || !sessions.empty() || (socket_fd >= 0))
+    {
+      if (served && sessions.empty())
+        {
+          // The socket file is removed first, so new clients start
+          // another daemon. The connections queued already are served
+          // here, otherwise their clients would wait in vain:
+          unlink(path.c_str());
+          linked = false;
+          while (admit(server, sessions));
+          release_fd(socket_fd);
+          continue;
+        }
+
+      pollfd watch[2];
+      watch[0].fd = finished[0];
+      watch[1].fd = socket_fd;
+      watch[0].events = watch[1].events = POLLIN;
+      if (poll(watch, (socket_fd >= 0) ? 2 : 1, -1) < 0)
+        {
+          if (errno != EINTR)
+            break;
+          continue;
+        }
+      if (watch[0].revents & POLLIN)
+        {
+          int client;
+          if (read(finished[0], &client, sizeof(client)) == sizeof(client))
+            {
+              session_map::iterator item = sessions.find(client);
+              if (item != sessions.end())
+                {
+                  item->second->thread.join();
+                  sessions.erase(item);
+                  close(client);
+                }
+            }
+        }
+      if ((socket_fd >= 0) && (watch[1].revents & POLLIN) &&
+          admit(server, sessions))
+        served = true;
+    }
+
+  // Sessions still running use the speech engines owned
+  // by the host, so they must be finished before return:
+  for (session_map::iterator item = sessions.begin(); item != sessions.end(); ++item)
+    {
+      shutdown(item->first, SHUT_RDWR);
+      item->second->thread.join();
+      close(item->first);
+    }
+  sessions.clear();
+  if (linked)
+    {
+      unlink(path.c_str());
+      linked = false;
+    }
+  release_fd(socket_fd);
+  release_fd(finished[0]);
+  release_fd(finished[1]);
+}
+
+int
+listener::connect(const string& socket_path)
+{
+  sockaddr_un address;
+  if (!socket_address(socket_path, address))
+    return -1;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if ((fd >= 0) && (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0))
+    {
+      close(fd);
+      fd = -1;
+    }
+  return fd;
+}
+
+bool
+listener::relay(int connection, string& unanswered, const string& fingerprint)
+{
+  vector<char> buffer(block_size);
+  string daemon_fingerprint;
+  bool greeted = false;
+  pollfd watch[2];
+  watch[0].fd = connection;
+  watch[1].fd = STDIN_FILENO;
+  watch[0].events = watch[1].events = POLLIN;
+  signal(SIGPIPE, SIG_IGN);
+  if (transfer(connection, unanswered.data(), unanswered.length()))
+    for (;;)
+      {
+        if (poll(watch, 2, -1) < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            break;
+          }
+        if (watch[0].revents)
+          {
+            ssize_t got = read(connection, buffer.data(), buffer.size());
+            if ((got < 0) && (errno == EINTR))
+              continue;
+            if (got <= 0)
+              break;
+            const char* data = buffer.data();
+            if (!greeted)
+              {
+                const char* end = static_cast<const char*>(memchr(data, '\0', got));
+                daemon_fingerprint.append(data, end ? end : data + got);
+                if (!end)
+                  continue;
+
+                // The session is set up, so the input
+                // will not be passed anywhere else:
+                greeted = true;
+                unanswered.clear();
+                got -= end + 1 - data;
+                data = end + 1;
+                if (daemon_fingerprint != fingerprint)
+                  {
+                    speech_server::log << SyslogStream::warning
+                                       << "daemon runs with different configuration, restart it to apply changes"
+                                       << endl;
+                    if (speech_server::verbose)
+                      cerr << "Daemon runs with different configuration, restart it to apply changes" << endl;
+                  }
+              }
+            if (!transfer(STDOUT_FILENO, data, got))
+              break;
+          }
+        if (watch[1].revents)
+          {
+            ssize_t got = read(STDIN_FILENO, buffer.data(), buffer.size());
+            if ((got < 0) && (errno == EINTR))
+              continue;
+            if (got <= 0)
+              {
+                // Let the daemon finish the session, but keep
+                // passing its replies until it closes connection:
+                shutdown(connection, SHUT_WR);
+                watch[1].fd = -1;
+              }
+            else
+              {
+                if (!greeted)
+                  unanswered.append(buffer.data(), got);
+                if (!transfer(connection, buffer.data(), got))
+                  break;
+              }
+          }
+      }
+  close(connection);
+  return greeted;
+}
+
+void
+listener::replay(const string& unanswered)
+{
+  int feeder[2];
+  if (unanswered.empty() || (pipe2(feeder, O_CLOEXEC) < 0))
+    return;
+  int source = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0);
+  if ((source < 0) || (dup2(feeder[0], STDIN_FILENO) < 0))
+    {
+      if (source >= 0)
+        close(source);
+      close(feeder[0]);
+      close(feeder[1]);
+      return;
+    }
+  close(feeder[0]);
+  boost::thread(feed, unanswered, source, feeder[1]).detach();
+}
+
+
+// Private methods:
+
+bool
+listener::admit(host& server, map< int, boost::shared_ptr<session> >& sessions)
+{
+  int client = accept4(socket_fd, NULL, NULL, SOCK_CLOEXEC);
+  if (client < 0)
+    return false;
+
+  // Accepted socket may inherit non-blocking mode:
+  fcntl(client, F_SETFL, fcntl(client, F_GETFL) & ~O_NONBLOCK);
+  try
+    {
+      boost::shared_ptr<session> item(new session(server.session(client), client, finished[1]));
+      if (!transfer(client, greeting.c_str(), greeting.length() + 1))
+        throw runtime_error("client disconnected before greeting");
+      item->thread = boost::thread(boost::ref(*item));
+      sessions[client] = item;
+    }
+  catch (const std::exception& failure)
+    {
+      speech_server::log << SyslogStream::err << failure.what() << endl;
+      close(client);
+    }
+  return true;
+}
+
+void
+listener::feed(string unanswered, int source, int sink)
+{
+  vector<char> buffer(block_size);
+  bool alive = transfer(sink, unanswered.data(), unanswered.length());
+  while (alive)
+    {
+      ssize_t got = read(source, buffer.data(), buffer.size());
+      if ((got < 0) && (errno == EINTR))
+        continue;
+      alive = (got > 0) && transfer(sink, buffer.data(), got);
+    }
+  close(source);
+  close(sink);
+}
+
+
+// Client session:
+
+listener::session::session(speech_server* session_server, int client_fd, int notice_fd):
+  server(session_server),
+  client(client_fd),
+  notice(notice_fd)
+{
+}
+
+void
+listener::session::operator()(void)
+{
+  try
+    {
+      server->run();
+    }
+  catch (const std::exception& failure)
+    {
+      speech_server::log << SyslogStream::err << failure.what() << endl;
+    }
+
+  // Let the listener join the thread and release the session:
+  if (write(notice, &client, sizeof(client)) < 0)
+    speech_server::log << SyslogStream::err << "session end notification failed: " << strerror(errno) << endl;
+}
@@ -0,0 +1,141 @@
+// listener.hpp -- Daemon mode sessions control interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// In daemon mode one process serves several clients, so speech engines,
+// caches and sound icons are loaded only once. The listener class
+// accepts client connections on a Unix domain socket and runs
+// a speech server session for each of them in its own thread,
+// so a client that does not read its replies holds up only
+// its own session. When the last client disconnects, the socket
+// is removed, and the daemon quits after serving the connections
+// that were queued before that.
+
+// Every client starts its own multispeech process as usual. This process
+// connects to the daemon socket, starting the daemon when necessary,
+// and then merely relays its standard input and output. The daemon
+// greets a client as soon as the session is set up, so the client
+// can tell a served connection from one closed by a quitting daemon
+// and retry elsewhere. The greeting is the configuration fingerprint
+// of the daemon terminated by zero byte. The daemon keeps
+// the configuration it has been started with, so a client
+// that has got another one only logs a warning about it.
+
+#ifndef MULTISPEECH_LISTENER_HPP
+#define MULTISPEECH_LISTENER_HPP
+
+#include <map>
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "speech_server.hpp"
+
+class listener
+{
+public:
+  // Sessions are constructed via this interface:
+  class host
+  {
+  public:
+    virtual speech_server* session(int client) = 0;
+  };
+
+  // Construct / destroy. The socket is bound and listened to at once,
+  // so clients can connect before serving starts. The runtime_error
+  // exception is thrown when it is impossible. Clients are greeted
+  // with specified configuration fingerprint.
+  listener(const std::string& socket_path, const std::string& fingerprint);
+  ~listener(void);
+
+  // Fork off the daemon process. Returns true in the daemon
+  // and false in the calling process, that does not serve
+  // the socket any more.
+  bool detach(void);
+
+  // Accept clients and serve their sessions until the last one
+  // disconnects. The socket is closed and removed on return:
+  void run(host& server);
+
+  // Connect to the daemon socket. Returns connected socket
+  // descriptor or -1 on failure:
+  static int connect(const std::string& socket_path);
+
+  // Pass standard input to the daemon and its replies to standard
+  // output until the connection is closed. The unanswered input
+  // is sent first. Returns false if the daemon closed connection
+  // without greeting. In this case all the input passed to it
+  // is left in unanswered for another attempt. A warning is logged
+  // when the daemon configuration fingerprint differs
+  // from the specified one.
+  static bool relay(int connection, std::string& unanswered,
+                    const std::string& fingerprint);
+
+  // Put unanswered input back in front of the standard input,
+  // so it is read by the standalone server:
+  static void replay(const std::string& unanswered);
+
+private:
+  // Client session running in its own thread:
+  class session
+  {
+  public:
+    session(speech_server* server, int client, int notice);
+
+    // The thread execution loop.
+    void operator()(void);
+
+    boost::scoped_ptr<speech_server> server;
+    const int client;
+    boost::thread thread;
+
+  private:
+    // Finished sessions report their client descriptors here:
+    const int notice;
+  };
+
+  // Accept one client and start its session. Returns false
+  // when there are no clients waiting:
+  bool admit(host& server, std::map< int, boost::shared_ptr<session> >& sessions);
+
+  // Pass the input left by replay() to the standard input pipe:
+  static void feed(std::string unanswered, int source, int sink);
+
+  // Socket file path:
+  const std::string path;
+
+  // Configuration fingerprint sent to clients as greeting:
+  const std::string greeting;
+
+  // Listening socket descriptor:
+  int socket_fd;
+
+  // Whether the socket file is still ours to remove:
+  bool linked;
+
+  // Finished sessions notification pipe:
+  int finished[2];
+
+  // Relay buffer size:
+  static const unsigned int block_size = 0x10000;
+};
+
+#endif
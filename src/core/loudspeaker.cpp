@@ -45,11 +45,11 @@ speech_task::speech_task(void):
 {
 }
 
-speech_task::speech_task(const string& txt, const pipeline::script& cmds,
+speech_task::speech_task(string txt, pipeline::script cmds,
                          soundfile::format fmt, details playing_params,
                          float loudness, float tempo_acceleration):
-  text(txt),
-  commands(cmds),
+  text(std::move(txt)),
+  commands(std::move(cmds)),
   format(fmt),
   playing(playing_params),
   volume(loudness),
@@ -81,6 +81,8 @@ loudspeaker::loudspeaker(condition& completion_event_consumer):
   soundfile(device.empty() ? audioplayer::device : device, "speech"),
   sound_processor(accelerator),
   host(completion_event_consumer),
+  tts(new pipeline),
+  spare(new pipeline),
   silence_timer(0),
   need_processing(false)
 {
@@ -96,6 +98,43 @@ loudspeaker::~loudspeaker(void)
 
 void
 loudspeaker::start(const speech_task& speech)
+{
+  cancel();
+  {
+    boost::mutex::scoped_lock lock(lookahead);
+    upcoming = speech_task();
+  }
+  submit(speech);
+}
+
+void
+loudspeaker::start(const speech_task& speech, const speech_task& next)
+{
+  cancel();
+  {
+    boost::mutex::scoped_lock lock(lookahead);
+    upcoming = next;
+  }
+  submit(speech);
+}
+
+void
+loudspeaker::stop(void)
+{
+  cancel();
+}
+
+bool
+loudspeaker::active(void)
+{
+  return !done();
+}
+
+
+// Private methods:
+
+void
+loudspeaker::execute(const speech_task& speech)
 {
   if (speech.format == silence)
     {
@@ -116,9 +155,12 @@ loudspeaker::start(const speech_task& speech)
           samplerate = speech.playing.sound.sampling;
         }
       sfd = -1;
-      tts.run(speech.commands, this);
-      tts << speech.text << endl;
-      tts.complete();
+      if (!take_prepared(speech))
+        {
+          tts->run(speech.commands, this);
+          *tts << speech.text << endl;
+          tts->complete();
+        }
       if (sfd >= 0)
         source = sf_open_fd(sfd, SFM_READ, this, 0);
       playing_rate = samplerate;
@@ -146,10 +188,21 @@ loudspeaker::start(const speech_task& speech)
         }
       else source_release();
     }
+  prepare();
 }
 
+void
+loudspeaker::abort(void)
+{
+  audioplayer::stop();
+  discard_prepared();
+}
 
-// Private methods:
+bool
+loudspeaker::busy(void)
+{
+  return audioplayer::active();
+}
 
 unsigned int
 loudspeaker::source_read(float* buffer, unsigned int nframes)
@@ -186,8 +239,9 @@ loudspeaker::source_release(void)
       sf_close(source);
       source = NULL;
     }
-  tts.stop();
-  tts.wait();
+  tts->stop();
+  tts->wait();
+  output.reset();
 }
 
 unsigned int
@@ -240,5 +294,73 @@ loudspeaker::attach(int fd)
 void
 loudspeaker::notify_completion(void)
 {
+  task_completed();
   host.notify_one();
 }
+
+void
+loudspeaker::prepare(void)
+{
+  speech_task next;
+  {
+    boost::mutex::scoped_lock lock(lookahead);
+    next = upcoming;
+    upcoming = speech_task();
+  }
+  if (same(next, prepared))
+    return;
+  discard_prepared();
+
+  // The backend output is collected in memory from the very start,
+  // so it never stalls on a full pipe until the task is played:
+  if ((next.format != none) && (next.format != silence) &&
+      !next.text.empty() && !next.commands.empty())
+    {
+      int current = sfd;
+      sfd = -1;
+      spare->run(next.commands, this);
+      if (sfd >= 0)
+        spare_output.reset(new stream_buffer(sfd));
+      *spare << next.text << endl;
+      spare->complete();
+      sfd = current;
+      prepared = std::move(next);
+    }
+}
+
+bool
+loudspeaker::take_prepared(const speech_task& speech)
+{
+  if (prepared.format == none)
+    return false;
+  if (!same(speech, prepared))
+    {
+      discard_prepared();
+      return false;
+    }
+  tts.swap(spare);
+  output.swap(spare_output);
+  sfd = output ? output->release() : -1;
+  prepared = speech_task();
+  return true;
+}
+
+void
+loudspeaker::discard_prepared(void)
+{
+  if (prepared.format != none)
+    {
+      spare->stop();
+      spare->wait();
+      spare_output.reset();
+      prepared = speech_task();
+    }
+}
+
+bool
+loudspeaker::same(const speech_task& first, const speech_task& second)
+{
+  return (first.format == second.format) &&
+    (first.text == second.text) &&
+    (first.commands == second.commands);
+}
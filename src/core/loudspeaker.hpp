@@ -20,12 +20,21 @@
 
 // The loudspeaker class takes care about external TTS pipeline
 // execution and provides generated sound stream playing capability.
+// Speech tasks are started and stopped by the dedicated thread,
+// so neither starting nor stopping blocks the caller. When the task
+// expected to follow is known, it is synthesized by a spare pipeline
+// while the current one is playing. Its output is collected in memory,
+// so the backend never waits for the player. Thus consecutive tasks,
+// e.g. language runs of a multilingual text, are spoken without delay
+// as long as synthesis is faster than playing.
 
 #ifndef MULTISPEECH_LOUDSPEAKER_HPP
 #define MULTISPEECH_LOUDSPEAKER_HPP
 
 #include <string>
 
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
 
 #include <soundtouch/SoundTouch.h>
@@ -33,6 +42,8 @@
 #include "soundfile.hpp"
 #include "sound_processor.hpp"
 #include "pipeline.hpp"
+#include "exec_queue.hpp"
+#include "stream_buffer.hpp"
 
 // Speech producing task description is represented by text string
 // to be spoken, external command set for TTS pipeline constructing,
@@ -58,19 +69,19 @@ public:
 
   // Object constructors:
   speech_task(void);
-  speech_task(const std::string& txt, const pipeline::script& cmds,
+  speech_task(std::string txt, pipeline::script cmds,
               soundfile::format fmt, details playing_params,
               float loudness = 1.0, float tempo_acceleration = 0.0);
   speech_task(unsigned int sampling, unsigned int silence_length);
 
 private:
   // Properties accessible only for actual executor:
-  const std::string text;
-  const pipeline::script commands;
-  const soundfile::format format;
-  const details playing;
-  const float volume;
-  const float accelerate;
+  std::string text;
+  pipeline::script commands;
+  soundfile::format format;
+  details playing;
+  float volume;
+  float accelerate;
 
   friend class loudspeaker;
 
@@ -81,16 +92,27 @@ private:
 class loudspeaker:
   public soundfile,
   private sound_processor,
-  private pipeline::consumer
+  private pipeline::consumer,
+  private exec_queue<speech_task>
 {
 public:
   // Construct / destroy:
   explicit loudspeaker(boost::condition& completion_event_consumer);
   ~loudspeaker(void);
 
-  // Start task execution:
+  // Start task execution stopping current one if any:
   void start(const speech_task& speech);
 
+  // The same, but the task to be started next is also specified,
+  // so it can be synthesized in advance:
+  void start(const speech_task& speech, const speech_task& next);
+
+  // Stop speaking and discard pending task if any:
+  void stop(void);
+
+  // Return true if speech is in progress:
+  bool active(void);
+
   // Configurable parameters:
   static std::string device;
   static float relative_volume;
@@ -120,17 +142,45 @@ private:
   // Attach to the sound stream by file descriptor:
   void attach(int fd);
 
+  // Methods required by exec_queue:
+  void execute(const speech_task& speech);
+  void abort(void);
+  bool busy(void);
+
   friend class pipeline;
 
   // Speech rate accelerator:
   soundtouch::SoundTouch accelerator;
 
-  // External TTS pipeline:
-  pipeline tts;
+  // Synthesize the upcoming task by the spare pipeline:
+  void prepare(void);
+
+  // Take the prepared output if it is for specified task,
+  // otherwise discard it. Returns true on success:
+  bool take_prepared(const speech_task& speech);
+
+  // Stop the spare pipeline if it is running:
+  void discard_prepared(void);
+
+  // Check if two tasks produce the same speech:
+  static bool same(const speech_task& first, const speech_task& second);
+
+  // External TTS pipelines. The spare one is used to synthesize
+  // the next task in advance:
+  boost::scoped_ptr<pipeline> tts, spare;
+
+  // Collected output of the pipelines when they were started
+  // in advance:
+  boost::scoped_ptr<stream_buffer> output, spare_output;
 
   // Attached sound stream fd:
   int sfd;
 
+  // The task expected to follow the current one
+  // and the task being synthesized in advance:
+  speech_task upcoming, prepared;
+  boost::mutex lookahead;
+
   // Silence time counter in samples:
   unsigned int silence_timer;
 
@@ -0,0 +1,124 @@
+// lru_cache.hpp -- Least recently used replacement storage
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The lru_cache class template keeps values indexed by keys
+// within the memory amount limit. Every value is stored along
+// with the amount it is charged for. When there is no room
+// for a new value, least recently used entries are dropped first.
+// No locking is done here, so the owner must take care
+// of concurrent access.
+
+#ifndef MULTISPEECH_LRU_CACHE_HPP
+#define MULTISPEECH_LRU_CACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <map>
+
+template <typename key_type, typename value_type>
+class lru_cache
+{
+public:
+  lru_cache(void):
+    used(0)
+  {
+  }
+
+  // Find the value for specified key and mark it as most recently
+  // used. Returns null pointer on miss:
+  const value_type* find(const key_type& key)
+  {
+    typename index::iterator item = storage.find(key);
+    if (item == storage.end())
+      return NULL;
+    recency.splice(recency.begin(), recency, item->second.usage);
+    return &item->second.value;
+  }
+
+  // Put new value replacing the old one with the same key.
+  // When the limit would be exceeded, least recently used entries
+  // are dropped if eviction is allowed. Returns false when
+  // the value cannot be stored.
+  bool store(const key_type& key, const value_type& value,
+             std::size_t amount, std::size_t limit, bool evict = true)
+  {
+    if (amount > limit)
+      return false;
+    erase(key);
+    while (used + amount > limit)
+      if (evict)
+        erase(recency.back());
+      else return false;
+    recency.push_front(key);
+    entry& slot = storage[key];
+    slot.value = value;
+    slot.amount = amount;
+    slot.usage = recency.begin();
+    used += amount;
+    return true;
+  }
+
+  // Remove the entry for specified key if any:
+  void erase(const key_type& key)
+  {
+    typename index::iterator item = storage.find(key);
+    if (item != storage.end())
+      {
+        used -= item->second.amount;
+        recency.erase(item->second.usage);
+        storage.erase(item);
+      }
+  }
+
+  // Number of entries:
+  std::size_t entries(void) const
+  {
+    return storage.size();
+  }
+
+  // Total amount charged for stored values:
+  std::size_t occupied(void) const
+  {
+    return used;
+  }
+
+private:
+  // Cache entry:
+  class entry
+  {
+  public:
+    value_type value;
+    std::size_t amount;
+    typename std::list<key_type>::iterator usage;
+  };
+
+  typedef std::map<key_type, entry> index;
+
+  // Stored values indexed by keys:
+  index storage;
+
+  // Keys in the order of usage, most recently used first:
+  std::list<key_type> recency;
+
+  // Memory amount currently occupied:
+  std::size_t used;
+};
+
+#endif
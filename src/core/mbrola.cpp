@@ -110,8 +110,9 @@ mbrola::mbrola(const string& backend,
 // Making up voice parameters:
 
 void
-mbrola::voicify(double rate, double pitch)
+mbrola::voicify(map<const char*, string>& macros,
+                double rate, double pitch) const
 {
-  format_macros[pitch_macro] = lexical_cast<string>(pitch);
-  format_macros[rate_macro] = lexical_cast<string>(1.0 / rate);
+  macros[pitch_macro] = lexical_cast<string>(pitch);
+  macros[rate_macro] = lexical_cast<string>(1.0 / rate);
 }
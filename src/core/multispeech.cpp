@@ -39,6 +39,10 @@ using namespace FBB;
 using namespace boost::locale;
 
 
+// How many times connection to the daemon is tried:
+static const unsigned int daemon_attempts = 3;
+
+
 // Construct / destroy:
 
 multispeech::multispeech(void):
@@ -66,13 +70,43 @@ multispeech::execute(int argc, char* argv[])
     {
       configuration conf(argc, argv, is_spd());
 
+      // Daemon must be started before any audio stuff:
+      const string& socket_path = is_spd() ?
+        speech_server::spd_socket :
+        speech_server::frontend_socket;
+      if (!socket_path.empty())
+        {
+          // A daemon that is quitting may close connection without
+          // serving it. Then another one is started and gets
+          // the input sent so far. When it fails as well,
+          // the input is passed to the standalone server:
+          string unanswered;
+          for (unsigned int attempt = 0; attempt < daemon_attempts; attempt++)
+            {
+              int connection = listener::connect(socket_path);
+              if (connection < 0)
+                connection = launch_daemon(socket_path);
+              if (connection < 0)
+                break;
+              if (listener::relay(connection, unanswered, configuration::digest))
+                {
+                  forget_stderr();
+                  return EXIT_SUCCESS;
+                }
+            }
+          if (!daemon)
+            listener::replay(unanswered);
+        }
+
       if (speech_server::verbose)
         cerr << "Initializing audio system..." << endl;
       audio.initialize();
       if (speech_server::verbose)
         cerr << "Audio system initialization complete." << endl;
 
-      app.reset(bootstrap());
+      if (daemon)
+        linguist.reset(new polyglot);
+      else app.reset(bootstrap());
     }
   catch (const string& info)
     {
@@ -98,12 +132,62 @@ multispeech::execute(int argc, char* argv[])
     }
 
   forget_stderr();
+  if (daemon)
+    {
+      linguist->warm_up();
+      daemon->run(*this);
+      return EXIT_SUCCESS;
+    }
   return app->run();
 }
 
 
 // Private methods:
 
+speech_server*
+multispeech::session(int client)
+{
+  return attach(client, *linguist);
+}
+
+int
+multispeech::launch_daemon(const string& socket_path)
+{
+  int connection = -1;
+  try
+    {
+      // The first client connects before the daemon is forked,
+      // so it does not quit prematurely:
+      daemon.reset(new listener(socket_path, configuration::digest));
+      connection = listener::connect(socket_path);
+      cout.flush();
+      if ((connection >= 0) && daemon->detach())
+        {
+          close(connection);
+          forget_stderr();
+          return -1;
+        }
+      daemon.reset();
+    }
+  catch (const std::exception& failure)
+    {
+      daemon.reset();
+      if (connection >= 0)
+        {
+          close(connection);
+          connection = -1;
+        }
+      speech_server::log << SyslogStream::warning << failure.what() << endl;
+      if (speech_server::verbose)
+        cerr << failure.what() << endl;
+    }
+
+  // Another daemon may be started concurrently:
+  if (connection < 0)
+    connection = listener::connect(socket_path);
+  return connection;
+}
+
 void
 multispeech::restore_stderr(void)
 {
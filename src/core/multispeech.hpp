@@ -23,6 +23,10 @@
 // and call execute method with the arguments of main() function.
 // Return value should be returned by main().
 
+// When daemon socket is configured for the protocol, the application
+// relays communication to the daemon, starting it if necessary.
+// Standalone mode is used as a fallback when the daemon is unavailable.
+
 #ifndef MULTISPEECH_HPP
 #define MULTISPEECH_HPP
 
@@ -33,8 +37,10 @@
 #include <portaudiocpp/AutoSystem.hxx>
 
 #include "speech_server.hpp"
+#include "polyglot.hpp"
+#include "listener.hpp"
 
-class multispeech
+class multispeech: private listener::host
 {
 public:
   // Construct / destroy:
@@ -49,6 +55,11 @@ private:
   // Must be implemented in a derived class.
   virtual speech_server* bootstrap(void) = 0;
 
+  // Should return a daemon session for the client connected
+  // via specified socket. Speech engines are shared by sessions.
+  // Must be implemented in a derived class.
+  virtual speech_server* attach(int client, polyglot& linguist) = 0;
+
   // Should return true if it is a Speech Dispatcher module.
   // Must be implemented in a derived class.
   virtual bool is_spd(void) = 0;
@@ -57,6 +68,14 @@ private:
   // Must be implemented in a derived class.
   virtual void report_error(const std::string& msg) = 0;
 
+  // Daemon session construction (see listener::host):
+  speech_server* session(int client);
+
+  // Start the daemon and connect to it. Returns connected socket
+  // descriptor or -1 on failure. In the daemon process
+  // the listener is set up instead.
+  int launch_daemon(const std::string& socket_path);
+
   // Stderr management helpers:
   void restore_stderr(void);
   void forget_stderr(void);
@@ -69,6 +88,10 @@ private:
 
   // Speech server holder:
   boost::scoped_ptr<speech_server> app;
+
+  // Daemon mode stuff:
+  boost::scoped_ptr<listener> daemon;
+  boost::scoped_ptr<polyglot> linguist;
 };
 
 #endif
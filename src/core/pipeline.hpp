@@ -32,6 +32,7 @@
 #include <ostream>
 #include <queue>
 #include <stack>
+#include <vector>
 
 #include <boost/scoped_ptr.hpp>
 
@@ -72,7 +73,7 @@ class pipeline:
 public:
   // Command set container. Commands are to be added by natural
   // order (from left to right) by the push() method.
-  typedef std::stack<std::string> script;
+  typedef std::stack<std::string, std::vector<std::string> > script;
 
   // Pipeline output consumer functor framework. Actual consumers
   // should be derived from this class and must provide implementation
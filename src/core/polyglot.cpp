@@ -18,13 +18,16 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+#include <cwctype>
 #include <iostream>
+#include <exception>
 #include <algorithm>
 #include <vector>
 #include <map>
 
 #include <bobcat/syslogstream>
 
+#include <boost/ref.hpp>
 #include <boost/assign.hpp>
 #include <boost/locale.hpp>
 
@@ -56,6 +59,7 @@ using namespace boost::locale;
 // Static data:
 string polyglot::language_preference;
 string polyglot::fallback_language(lang_id::en);
+unsigned int polyglot::chunk_size = 0;
 
 // Supported languages:
 static vector<const char*> langs = list_of
@@ -78,6 +82,16 @@ static const map<const char*, const string*> backends = map_list_of
   (lang_id::ru, &Russian::settings.engine)
   .convert_to_container< map<const char*, const string*> >();
 
+static const map<const char*, const wchar_t*> alphabets = map_list_of
+  (lang_id::en, English::alphabet)
+  (lang_id::de, German::alphabet)
+  (lang_id::it, Italian::alphabet)
+  (lang_id::fr, French::alphabet)
+  (lang_id::es, Spanish::alphabet)
+  (lang_id::pt, Portuguese::alphabet)
+  (lang_id::ru, Russian::alphabet)
+  .convert_to_container< map<const char*, const wchar_t*> >();
+
 static const map<const char*, const int*> priorities = map_list_of
   (lang_id::en, &English::settings.priority)
   (lang_id::de, &German::settings.priority)
@@ -88,6 +102,65 @@ static const map<const char*, const int*> priorities = map_list_of
   (lang_id::ru, &Russian::settings.priority)
   .convert_to_container< map<const char*, const int*> >();
 
+// Non-ASCII characters that are never changed by NFKC normalization
+// and never take part in composition, i.e. having NFKC_QC=Yes
+// and zero canonical combining class. Only the blocks used
+// in the supported languages are included: Latin, Greek, Cyrillic,
+// General Punctuation and Currency Symbols. Taken from ICU 72.1.
+// Any other character causes full normalization.
+static const struct
+{
+  wchar_t first, last;
+} nfkc_stable_chars[] = {
+    { 0x0080, 0x009F },
+    { 0x00A1, 0x00A7 },
+    { 0x00A9, 0x00A9 },
+    { 0x00AB, 0x00AE },
+    { 0x00B0, 0x00B1 },
+    { 0x00B6, 0x00B7 },
+    { 0x00BB, 0x00BB },
+    { 0x00BF, 0x0131 },
+    { 0x0134, 0x013E },
+    { 0x0141, 0x0148 },
+    { 0x014A, 0x017E },
+    { 0x0180, 0x01C3 },
+    { 0x01CD, 0x01F0 },
+    { 0x01F4, 0x02AF },
+    { 0x02B9, 0x02D7 },
+    { 0x02DE, 0x02DF },
+    { 0x02E5, 0x02FF },
+    { 0x034F, 0x034F },
+    { 0x0370, 0x0373 },
+    { 0x0375, 0x0377 },
+    { 0x037B, 0x037D },
+    { 0x037F, 0x037F },
+    { 0x0386, 0x0386 },
+    { 0x0388, 0x038A },
+    { 0x038C, 0x038C },
+    { 0x038E, 0x03A1 },
+    { 0x03A3, 0x03CF },
+    { 0x03D7, 0x03EF },
+    { 0x03F3, 0x03F3 },
+    { 0x03F6, 0x03F8 },
+    { 0x03FA, 0x0482 },
+    { 0x0488, 0x052F },
+    { 0x200B, 0x2010 },
+    { 0x2012, 0x2016 },
+    { 0x2018, 0x2023 },
+    { 0x2027, 0x202E },
+    { 0x2030, 0x2032 },
+    { 0x2035, 0x2035 },
+    { 0x2038, 0x203B },
+    { 0x203D, 0x203D },
+    { 0x203F, 0x2046 },
+    { 0x204A, 0x2056 },
+    { 0x2058, 0x205E },
+    { 0x2060, 0x2064 },
+    { 0x2066, 0x206F },
+    { 0x20A0, 0x20A7 },
+    { 0x20A9, 0x20C0 }
+};
+
 // Language comparator:
 static bool
 order(const char* lang1, const char* lang2)
@@ -96,13 +169,30 @@ order(const char* lang1, const char* lang2)
 }
 
 
-// Construct the object:
+// Character classification:
+
+polyglot::char_class::char_class(void):
+  identified(0),
+  strange(0),
+  known(false)
+{
+}
+
+
+// Construct / destroy:
 
 polyglot::polyglot(void):
+  engines(langs.size()),
   talker(langs.size()),
+  attempted(0),
+  working(0),
+  construction(langs.size()),
   lang(langs.size()),
   fallback(langs.size()),
-  autolanguage(false)
+  autolanguage(false),
+  char_table(table_size),
+  classified(0),
+  normalization("NFKC normalization", "normalized", "texts")
 {
   bool initialized = false;
   stable_sort(langs.begin(), langs.end(), order);
@@ -113,7 +203,10 @@ polyglot::polyglot(void):
         if ((engine != speech_engine::disabled) &&
             !engine.empty())
           {
-            talker[i].reset(speech_backend(engine, langs[i]));
+            if (!known_backend(engine))
+              throw configuration::error("unknown speech backend " + engine);
+            engines[i] = engine;
+            language_description::add_alphabet(langs[i], alphabets.at(langs[i]));
             if (langs[i] == fallback_language)
               fallback = i;
             initialized = true;
@@ -133,26 +226,34 @@ polyglot::polyglot(void):
         throw configuration::error("unsupported language " + language_preference);
       for (unsigned int i = 0; i < langs.size(); i++)
         {
-          if ((lang < langs.size()) && talker[lang].get())
+          if ((lang < langs.size()) && configured(lang))
             break;
           lang = i;
         }
     }
-  if ((lang >= langs.size()) || !talker[lang].get())
+  if ((lang >= langs.size()) || !backend(lang))
     throw configuration::error("no speech backend for chosen language");
 }
 
+polyglot::~polyglot(void)
+{
+  if (preparation.joinable())
+    preparation.join();
+}
+
 
 // Public methods:
 
 speech_task
 polyglot::text_task(const wstring& s, bool use_translation)
 {
-  wstring t = normalize(s, norm_nfkc);
+  wstring buffer;
+  const wstring& t = normalized(s, buffer);
   if (autolanguage)
     detect_language(t, use_translation);
-  if (talker[lang].get())
-    return talker[lang]->text_task(t, use_translation);
+  speech_engine* speaker = backend(lang);
+  if (speaker)
+    return speaker->text_task(t, use_translation);
   return speech_task();
 }
 
@@ -161,47 +262,81 @@ polyglot::text_task(const wstring& s,
                     voice_params* voice,
                     bool use_translation)
 {
-  wstring t = normalize(s, norm_nfkc);
+  wstring buffer;
+  const wstring& t = normalized(s, buffer);
   if (autolanguage)
     detect_language(t, use_translation);
-  if (talker[lang].get())
-    {
-      punctuations::mode preserve = punctuations::verbosity;
-      punctuations::verbosity = voice->punctuations_mode;
-      speech_task task = talker[lang]->text_task(t, voice, use_translation);
-      punctuations::verbosity = preserve;
-      return task;
-    }
+  speech_engine* speaker = backend(lang);
+  if (speaker)
+    return speaker->text_task(t, voice, use_translation);
   return speech_task();
 }
 
 speech_task
 polyglot::letter_task(const wstring& s)
 {
-  wstring t = normalize(s, norm_nfkc);
+  wstring buffer;
+  const wstring& t = normalized(s, buffer);
   if (autolanguage)
     detect_language(t, true);
-  if (talker[lang].get())
-    return talker[lang]->letter_task(t);
+  speech_engine* speaker = backend(lang);
+  if (speaker)
+    return speaker->letter_task(t);
   return speech_task();
 }
 
 speech_task
 polyglot::letter_task(const wstring& s, voice_params* voice)
 {
-  wstring t = normalize(s, norm_nfkc);
+  wstring buffer;
+  const wstring& t = normalized(s, buffer);
   if (autolanguage)
     detect_language(t, true);
-  if (talker[lang].get())
-    return talker[lang]->letter_task(t, voice);
+  speech_engine* speaker = backend(lang);
+  if (speaker)
+    return speaker->letter_task(t, voice);
   return speech_task();
 }
 
+vector<speech_task>
+polyglot::text_tasks(const wstring& s, voice_params* voice, bool use_translation)
+{
+  vector<speech_task> tasks;
+  wstring buffer;
+  const wstring& t = normalized(s, buffer);
+  if (!autolanguage)
+    append_tasks(tasks, t, voice, use_translation);
+  else
+    {
+      unsigned int available = detection_backends();
+      size_t start = 0;
+      do
+        {
+          size_t end = language_run(t, start, available);
+          if (!start && (end == t.length()))
+            {
+              detect_language(t, use_translation);
+              append_tasks(tasks, t, voice, use_translation);
+            }
+          else
+            {
+              wstring run(t, start, end - start);
+              detect_language(run, use_translation);
+              append_tasks(tasks, run, voice, use_translation);
+            }
+          start = end;
+        }
+      while (start < t.length());
+    }
+  return tasks;
+}
+
 speech_task
 polyglot::silence(double duration)
 {
-  if (talker[lang].get())
-    return talker[lang]->silence(duration);
+  speech_engine* speaker = backend(lang);
+  if (speaker)
+    return speaker->silence(duration);
   return speech_task();
 }
 
@@ -211,14 +346,14 @@ polyglot::language(const string& id)
   for (unsigned int i = 0; i < langs.size(); i++)
     if (id == langs[i])
       {
-        if (talker[i].get())
+        if (backend(i))
           {
             lang = i;
             autolanguage = false;
           }
         else if (speech_server::debug)
           {
-            string message("Language \"" + id + "\" is not configured");
+            string message("Language \"" + id + "\" is not available");
             speech_server::log << SyslogStream::debug << message << endl;
             if (speech_server::verbose)
               cerr << message << endl;
@@ -241,7 +376,23 @@ polyglot::language(void) const
 {
   if (autolanguage)
     return lang_id::autodetect;
-  return talker[lang]->language->id;
+  return langs[lang];
+}
+
+polyglot::choice
+polyglot::current_choice(void) const
+{
+  choice result;
+  result.lang = lang;
+  result.autolanguage = autolanguage;
+  return result;
+}
+
+void
+polyglot::restore(const choice& saved)
+{
+  lang = saved.lang;
+  autolanguage = saved.autolanguage;
 }
 
 void
@@ -249,7 +400,7 @@ polyglot::lang_switch(bool direction)
 {
   int i = autolanguage ? (direction ? -1 : langs.size()) : lang;
   do i += direction ? 1 : -1;
-  while ((i >= 0) && (static_cast<unsigned int>(i) < langs.size()) && !talker[i].get());
+  while ((i >= 0) && (static_cast<unsigned int>(i) < langs.size()) && !backend(i));
   if ((i >= 0) && (static_cast<unsigned int>(i) < langs.size()))
     {
       lang = static_cast<unsigned int>(i);
@@ -258,30 +409,94 @@ polyglot::lang_switch(bool direction)
   else autolanguage = true;
 }
 
+unsigned int
+polyglot::languages(void) const
+{
+  return langs.size();
+}
+
+speech_engine*
+polyglot::backend(unsigned int i)
+{
+  if (!(attempted & (1 << i)))
+    {
+      boost::mutex::scoped_lock lock(construction[i]);
+      if (!(attempted & (1 << i)))
+        {
+          if (configured(i))
+            try
+              {
+                talker[i].reset(speech_backend(engines[i], langs[i]));
+                working |= 1 << i;
+              }
+            catch (const std::exception& failure)
+              {
+                string message(string(langs[i]) + " speech backend is unavailable: " + failure.what());
+                speech_server::log << SyslogStream::err << message << endl;
+                if (speech_server::verbose)
+                  cerr << message << endl;
+              }
+          attempted |= 1 << i;
+        }
+    }
+  return talker[i].get();
+}
+
+void
+polyglot::warm_up(void)
+{
+  if (!preparation.joinable())
+    preparation = boost::thread(boost::ref(*this));
+}
+
+void
+polyglot::operator()(void)
+{
+  for (unsigned int i = 0; i < langs.size(); i++)
+    backend(i);
+}
+
 
 // Private methods:
 
 void
 polyglot::detect_language(const wstring& s, bool check_translation)
 {
+  unsigned int available = detection_backends();
+  speech_engine* speaker = backend(lang);
   if (!check_translation || (s.length() == 1) ||
-      talker[lang]->language->translate(s).empty())
+      !speaker || !speaker->language->translate(s))
     {
+      // Scan the text once collecting character classes.
+      // The scan stops as soon as the first language
+      // in the detection order is revealed.
+      unsigned int identified = 0, strange = 0;
+      unsigned int leader = available & ~(available - 1);
+      for (wstring::const_iterator c = s.begin(); (c != s.end()) && !(identified & leader); ++c)
+        {
+          const char_class& item = classify(*c);
+          identified |= item.identified;
+          strange |= item.strange;
+        }
+
+      // Word patterns are checked only when characters
+      // do not reveal the language:
       unsigned int newlang = langs.size();
       for (unsigned int i = 0; i < langs.size(); i++)
-        if (talker[i].get() && talker[i]->language->recognize(s))
+        if ((available & (1 << i)) &&
+            ((identified & (1 << i)) || talker[i]->language->guess(s)))
           {
             newlang = i;
             break;
           }
       if (newlang < langs.size())
         lang = newlang;
-      else if (talker[lang]->language->foreign(s))
+      else if (strange & (1 << lang))
         {
-          if (talker[fallback]->language->foreign(s))
+          if ((strange & (1 << fallback)) || !(available & (1 << fallback)))
             {
               for (unsigned int i = 0; i < langs.size(); i++)
-                if ((i != lang) && (i != fallback) && talker[i].get() && !talker[i]->language->foreign(s))
+                if ((i != lang) && (i != fallback) && (available & (1 << i)) && !(strange & (1 << i)))
                   {
                     lang = i;
                     break;
@@ -292,6 +507,149 @@ polyglot::detect_language(const wstring& s, bool check_translation)
     }
 }
 
+unsigned int
+polyglot::detection_backends(void)
+{
+  // Once every backend has been tried, the set never changes:
+  if (attempted != (1U << langs.size()) - 1)
+    for (unsigned int i = 0; i < langs.size(); i++)
+      backend(i);
+  unsigned int available = working;
+  if (classified != available)
+    {
+      char_table.assign(table_size, char_class());
+      rare_chars.clear();
+      classified = available;
+    }
+  return available;
+}
+
+size_t
+polyglot::language_run(const wstring& s, size_t start, unsigned int available)
+{
+  unsigned int common = available;
+  bool lettered = false;
+  size_t i = start;
+  while (i < s.length())
+    {
+      size_t word = i;
+      unsigned int identified = 0, strange = 0;
+      bool letters = false;
+      for (; (i < s.length()) && !iswspace(s[i]); i++)
+        if (iswalpha(s[i]))
+          {
+            const char_class& item = classify(s[i]);
+            identified |= item.identified;
+            strange |= item.strange;
+            letters = true;
+          }
+      if (letters)
+        {
+          unsigned int admitting = (identified ? identified : ~strange) & available;
+          if (lettered && !(common & admitting))
+            return word;
+          if (common & admitting)
+            common &= admitting;
+          lettered = true;
+        }
+      while ((i < s.length()) && iswspace(s[i]))
+        i++;
+    }
+  return s.length();
+}
+
+void
+polyglot::append_tasks(vector<speech_task>& tasks, const wstring& s,
+                       voice_params* voice, bool use_translation)
+{
+  speech_engine* speaker = backend(lang);
+  if (!speaker)
+    tasks.push_back(speech_task());
+  else if (!chunk_size || (s.length() <= chunk_size))
+    tasks.push_back(voice ?
+                    speaker->text_task(s, voice, use_translation) :
+                    speaker->text_task(s, use_translation));
+  else
+    for (size_t start = 0; start < s.length();)
+      {
+        size_t end = speaker->language->split_point(s, start, chunk_size);
+        wstring chunk(s, start, end - start);
+        tasks.push_back(voice ?
+                        speaker->text_task(chunk, voice, use_translation) :
+                        speaker->text_task(chunk, use_translation));
+        start = end;
+      }
+}
+
+const polyglot::char_class&
+polyglot::classify(wchar_t c)
+{
+  char_class& item = (static_cast<unsigned int>(c) < table_size) ? char_table[c] : rare_chars[c];
+  if (!item.known)
+    {
+      for (unsigned int i = 0; i < langs.size(); i++)
+        if (classified & (1 << i))
+          {
+            if (talker[i]->language->identifies(c))
+              item.identified |= 1 << i;
+            if (!talker[i]->language->admits(c))
+              item.strange |= 1 << i;
+          }
+      item.known = true;
+    }
+  return item;
+}
+
+const wstring&
+polyglot::normalized(const wstring& s, wstring& buffer)
+{
+  bool stable = nfkc_stable(s);
+  if (!stable)
+    buffer = normalize(s, norm_nfkc);
+  if (normalization.count(!stable))
+    normalization.report();
+  return stable ? s : buffer;
+}
+
+bool
+polyglot::nfkc_stable(const wstring& s)
+{
+  static const size_t ranges = sizeof(nfkc_stable_chars) / sizeof(nfkc_stable_chars[0]);
+  for (wstring::const_iterator c = s.begin(); c != s.end(); ++c)
+    if (static_cast<unsigned int>(*c) >= 0x80)
+      {
+        if (*c > nfkc_stable_chars[ranges - 1].last)
+          return false;
+        size_t low = 0, high = ranges;
+        while (low < high)
+          {
+            size_t middle = (low + high) / 2;
+            if (nfkc_stable_chars[middle].last < *c)
+              low = middle + 1;
+            else high = middle;
+          }
+        if (*c < nfkc_stable_chars[low].first)
+          return false;
+      }
+  return true;
+}
+
+bool
+polyglot::configured(unsigned int i) const
+{
+  return !engines[i].empty();
+}
+
+bool
+polyglot::known_backend(const string& name)
+{
+  return (freephone::name == name) ||
+    (ru_tts::name == name) ||
+    (espeak::name == name) ||
+    (mbrola::name == name) ||
+    (user_tts::name == name);
+}
+
 speech_engine*
 polyglot::speech_backend(const string& name,
                          const char* lang)
@@ -21,26 +21,44 @@
 // Main purpose of the polyglot class is to provide general interface
 // to the multilingual speech synthesis functionality.
 
+// Speech backends along with their language descriptions are not
+// constructed at once, since it takes a while and some languages
+// may be never used in a session. Only the backend for the initially
+// chosen language is constructed by the polyglot constructor, so the
+// server does not start without it. The rest are constructed
+// on first request. The warm_up() method starts a background thread
+// preparing all configured backends in advance, so it should be called
+// when the server is ready to accept commands. A language which backend
+// cannot be constructed is never chosen.
+
 #ifndef MULTISPEECH_POLYGLOT_HPP
 #define MULTISPEECH_POLYGLOT_HPP
 
+#include <cstddef>
+#include <atomic>
 #include <string>
 #include <vector>
+#include <map>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "speech_engine.hpp"
 #include "voice_params.hpp"
+#include "hit_rate.hpp"
 
 class polyglot
 {
 public:
-  // Construct the object:
+  // Construct / destroy:
   polyglot(void);
+  ~polyglot(void);
 
   // Configurable parameters:
   static std::string language_preference;
   static std::string fallback_language;
+  static unsigned int chunk_size;
 
   // Prepare speech task:
   speech_task text_task(const std::wstring& s,
@@ -51,30 +69,110 @@ public:
   speech_task letter_task(const std::wstring& s);
   speech_task letter_task(const std::wstring& s, voice_params* voice);
 
+  // Prepare a series of speech tasks for the text that may be long
+  // or multilingual. When language autodetection is on, the text
+  // is divided into runs of words having some language in common,
+  // and each run is spoken by its own backend. Runs exceeding
+  // chunk_size characters are split at sentence or clause
+  // boundaries, so the first part can be spoken while the rest
+  // is still being processed. Null voice means defaults.
+  std::vector<speech_task> text_tasks(const std::wstring& s,
+                                      voice_params* voice = NULL,
+                                      bool use_translation = false);
+
   // Make up special task to produce silence for the time
   // duration specified in seconds:
   speech_task silence(double duration);
 
-  // Choose language:
+  // Choose language. Its backend is constructed when necessary:
   void language(const std::string& id);
 
   // Return current language id string:
   const char* language(void) const;
 
+  // Language choice snapshot, including the autodetection state.
+  // Daemon sessions keep their own choices this way:
+  class choice
+  {
+  private:
+    unsigned int lang;
+    bool autolanguage;
+    friend class polyglot;
+  };
+
+  // Take and restore language choice snapshot:
+  choice current_choice(void) const;
+  void restore(const choice& saved);
+
   // Switch language in specified direction:
   // true -- forward, false -- backward.
   void lang_switch(bool direction);
 
-  // Multilingual speech engine:
-  std::vector< boost::shared_ptr<speech_engine> > talker;
+  // Number of supported languages:
+  unsigned int languages(void) const;
+
+  // Speech backend for the language specified by number.
+  // Null pointer is returned when the language is not configured
+  // or its backend cannot be constructed.
+  speech_engine* backend(unsigned int i);
+
+  // Start background preparation of all configured backends:
+  void warm_up(void);
+
+  // The thread execution loop.
+  void operator()(void);
 
 private:
+  // Configured backend names indexed by language number.
+  // Empty name means that the language is not configured.
+  std::vector<std::string> engines;
+
+  // Multilingual speech engine. Backends are constructed on demand:
+  std::vector< boost::shared_ptr<speech_engine> > talker;
+
+  // Languages which backends construction is already attempted
+  // and ones with working backends as bit masks:
+  std::atomic<unsigned int> attempted, working;
+
+  // Backend construction guards. Every backend is constructed
+  // only once, and a request for a backend that is not constructed
+  // yet waits only for that one. After the attempt no lock is taken:
+  std::vector<boost::mutex> construction;
+
+  // Background preparation thread handler:
+  boost::thread preparation;
+
+  // Check if the language is configured:
+  bool configured(unsigned int i) const;
+
+
   // Detect language from text content:
   void detect_language(const std::wstring& s, bool check_translation = false);
 
+  // Bring up all configured backends for language detection
+  // and return the mask of working ones. Characters classification
+  // made for another set of backends is dropped:
+  unsigned int detection_backends(void);
+
+  // Find where the language run starting at specified position ends.
+  // The run is broken before a word that cannot be spoken in any
+  // of the languages admitting all the preceding words. Only letters
+  // are taken into account, other characters join the current run.
+  // The mask argument specifies languages with available backends.
+  std::size_t language_run(const std::wstring& s, std::size_t start,
+                           unsigned int available);
+
+  // Append tasks for the text spoken in current language,
+  // splitting it into chunks when necessary:
+  void append_tasks(std::vector<speech_task>& tasks, const std::wstring& s,
+                    voice_params* voice, bool use_translation);
+
+  // Check if speech backend name is known:
+  static bool known_backend(const std::string& name);
+
   // Construct speech backend by name:
-  speech_engine* speech_backend(const std::string& name,
-                                const char* lang);
+  static speech_engine* speech_backend(const std::string& name,
+                                       const char* lang);
 
   // Currently used language:
   unsigned int lang;
@@ -84,6 +182,44 @@ private:
 
   // Language autodetection enabling flag:
   bool autolanguage;
+
+  // Character classification for language detection.
+  // Bit number i in the masks corresponds to the language
+  // number i in the talker list.
+  class char_class
+  {
+  public:
+    char_class(void);
+
+    unsigned int identified; // languages revealed by the character
+    unsigned int strange; // languages the character is foreign for
+    bool known; // classification is already done
+  };
+
+  // Characters classification is done on demand and stored
+  // in the table indexed directly by character code
+  // or in the map for the rest of characters:
+  static const unsigned int table_size = 0x800;
+  std::vector<char_class> char_table;
+  std::map<wchar_t, char_class> rare_chars;
+
+  // Languages the classification is made for:
+  unsigned int classified;
+
+  // Get classification for specified character:
+  const char_class& classify(wchar_t c);
+
+  // NFKC normalization. The text is returned untouched when
+  // quick check shows it to be normalized already. Otherwise
+  // the result is placed in the buffer provided.
+  const std::wstring& normalized(const std::wstring& s, std::wstring& buffer);
+
+  // Normalization statistics. It is updated from several threads,
+  // so the counters are atomic:
+  hit_rate normalization;
+
+  // NFKC quick check:
+  static bool nfkc_stable(const std::wstring& s);
 };
 
 #endif
@@ -0,0 +1,118 @@
+// ring_queue.hpp -- First in first out queue reusing its storage
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The ring_queue class template keeps values in a circular buffer.
+// Values are moved into the slots, and a slot is reset to the default
+// value when the item is removed, so resources held by the value
+// are released at once. The buffer grows twice when it is full
+// and never shrinks, so once the queue has reached its usual depth,
+// submission and removal do not allocate memory. Every queue
+// has its own buffer, so no locking is done here.
+
+#ifndef MULTISPEECH_RING_QUEUE_HPP
+#define MULTISPEECH_RING_QUEUE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename value_type>
+class ring_queue
+{
+public:
+  ring_queue(void):
+    head(0),
+    count(0)
+  {
+  }
+
+  // Put new value at the end of the queue:
+  void push_back(value_type&& value)
+  {
+    if (count == slots.size())
+      grow();
+    slots[(head + count) % slots.size()] = std::move(value);
+    count++;
+  }
+
+  // Access the item at specified position counting from the front:
+  value_type& operator[](std::size_t position)
+  {
+    return slots[(head + position) % slots.size()];
+  }
+
+  const value_type& operator[](std::size_t position) const
+  {
+    return slots[(head + position) % slots.size()];
+  }
+
+  // The first item:
+  value_type& front(void)
+  {
+    return slots[head];
+  }
+
+  // Remove the first item:
+  void pop_front(void)
+  {
+    slots[head] = value_type();
+    head = (head + 1) % slots.size();
+    count--;
+  }
+
+  // Remove all items keeping the buffer:
+  void clear(void)
+  {
+    while (count)
+      pop_front();
+    head = 0;
+  }
+
+  // Number of items:
+  std::size_t size(void) const
+  {
+    return count;
+  }
+
+  bool empty(void) const
+  {
+    return !count;
+  }
+
+private:
+  // Circular buffer and the occupied part of it:
+  std::vector<value_type> slots;
+  std::size_t head, count;
+
+  // Initial buffer size:
+  static const std::size_t initial_size = 16;
+
+  // Enlarge the buffer keeping the items order:
+  void grow(void)
+  {
+    std::vector<value_type> enlarged(slots.empty() ? initial_size : (slots.size() * 2));
+    for (std::size_t i = 0; i < count; i++)
+      enlarged[i] = std::move((*this)[i]);
+    slots.swap(enlarged);
+    head = 0;
+  }
+};
+
+#endif
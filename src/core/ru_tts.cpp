@@ -23,7 +23,6 @@
 #include <cmath>
 #include <cstdio>
 
-#include <boost/assign.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
@@ -37,7 +36,6 @@
 
 using namespace std;
 using namespace boost;
-using namespace boost::assign;
 using namespace boost::filesystem;
 using namespace FBB;
 
@@ -62,8 +60,11 @@ double ru_tts::exclamation_gap_factor = 1.0;
 double ru_tts::intonational_gap_factor = 1.0;
 
 // Backend specific substitutions:
-static const map<wchar_t, const wchar_t*> substitutions = map_list_of
-  (0x301, L"+");
+static const char_translations::item substitutions[] =
+  {
+    { 0x301, L"+" },
+    { 0, NULL }
+  };
 
 
 // Object construction:
@@ -161,7 +162,8 @@ ru_tts::ru_tts(void):
 // Making up voice parameters:
 
 void
-ru_tts::voicify(double rate, double pitch)
+ru_tts::voicify(map<const char*, string>& macros,
+                double rate, double pitch) const
 {
   if (version < 6.0)
     {
@@ -174,8 +176,8 @@ ru_tts::voicify(double rate, double pitch)
       else if (rate < 1.0)
         r = 1.0 / (rate + 1.0);
       else r = 1.0 / rate - 0.5;
-      format_macros[pitch_macro] = lexical_cast<string>(atan(p * p / 5.0) * M_2_PI);
-      format_macros[rate_macro] = lexical_cast<string>(r);
+      macros[pitch_macro] = lexical_cast<string>(atan(p * p / 5.0) * M_2_PI);
+      macros[rate_macro] = lexical_cast<string>(r);
     }
-  else speech_engine::voicify(rate, pitch);
+  else speech_engine::voicify(macros, rate, pitch);
 }
@@ -0,0 +1,160 @@
+// sound_cache.cpp -- Decoded sound files cache implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <sstream>
+
+#include <sndfile.h>
+
+#include "sound_cache.hpp"
+
+using namespace std;
+using namespace boost;
+using namespace boost::filesystem;
+
+
+// Static data definition:
+unsigned int sound_cache::capacity = 8192;
+string sound_cache::preload_path;
+lru_cache<string, boost::shared_ptr<const sound_cache::clip> > sound_cache::storage;
+hit_rate sound_cache::statistics("sound cache");
+boost::mutex sound_cache::access;
+
+
+// Decoded sound data:
+
+unsigned int
+sound_cache::clip::frames(void) const
+{
+  return channels ? samples.size() / channels : 0;
+}
+
+
+// Public methods:
+
+boost::shared_ptr<const sound_cache::clip>
+sound_cache::lookup(const path& sound_file)
+{
+  if (!capacity)
+    return boost::shared_ptr<const clip>();
+  system::error_code failure;
+  time_t mtime = last_write_time(sound_file, failure);
+  if (failure)
+    return boost::shared_ptr<const clip>();
+  string name(sound_file.generic_string());
+  {
+    boost::mutex::scoped_lock lock(access);
+    const boost::shared_ptr<const clip>* cached = storage.find(name);
+    bool hit = cached && ((*cached)->mtime == mtime);
+    if (statistics.count(hit))
+      report();
+    if (hit)
+      return *cached;
+    if (cached)
+      storage.erase(name);
+  }
+  boost::shared_ptr<clip> data(decode(sound_file, limit()));
+  if (data)
+    {
+      data->mtime = mtime;
+      boost::mutex::scoped_lock lock(access);
+      storage.store(name, data, size(*data), limit());
+    }
+  return data;
+}
+
+void
+sound_cache::preload(const path& directory)
+{
+  if (!capacity || directory.empty())
+    return;
+  system::error_code failure;
+  for (directory_iterator file(directory, failure); !failure && (file != directory_iterator()); file.increment(failure))
+    {
+      if (!is_regular_file(file->status()))
+        continue;
+      time_t mtime = last_write_time(file->path(), failure);
+      if (failure)
+        continue;
+      size_t room;
+      {
+        boost::mutex::scoped_lock lock(access);
+        room = limit() - storage.occupied();
+      }
+      boost::shared_ptr<clip> data(decode(file->path(), room));
+      if (data)
+        {
+          data->mtime = mtime;
+          boost::mutex::scoped_lock lock(access);
+          if (!storage.store(file->path().generic_string(), data,
+                             size(*data), limit(), false))
+            break;
+        }
+    }
+}
+
+
+// Private methods:
+
+boost::shared_ptr<sound_cache::clip>
+sound_cache::decode(const path& sound_file, size_t limit)
+{
+  boost::shared_ptr<clip> data;
+  SF_INFO info;
+  info.format = 0;
+  SNDFILE* source = sf_open(sound_file.generic_string().c_str(), SFM_READ, &info);
+  if (source)
+    {
+      if ((info.frames > 0) && (info.channels > 0) &&
+          (static_cast<size_t>(info.frames) * info.channels * sizeof(float) <= limit))
+        {
+          data.reset(new clip);
+          data->rate = info.samplerate;
+          data->channels = info.channels;
+          data->samples.resize(info.frames * info.channels);
+          sf_count_t obtained = sf_readf_float(source, &data->samples[0], info.frames);
+          if (obtained > 0)
+            data->samples.resize(obtained * info.channels);
+          else data.reset();
+        }
+      sf_close(source);
+    }
+  return data;
+}
+
+void
+sound_cache::report(void)
+{
+  ostringstream details;
+  details << storage.entries() << " entries, "
+          << (storage.occupied() >> 10) << "K occupied";
+  statistics.report(details.str());
+}
+
+size_t
+sound_cache::size(const clip& data)
+{
+  return data.samples.size() * sizeof(float);
+}
+
+size_t
+sound_cache::limit(void)
+{
+  return static_cast<size_t>(capacity) << 10;
+}
@@ -0,0 +1,95 @@
+// sound_cache.hpp -- Decoded sound files cache interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The sound_cache class keeps recently played sound files in memory
+// already decoded into the sample format used for playback, so
+// frequently used sound icons can be played without any disk access
+// or decoding. Total memory consumption is limited by configurable
+// capacity. Least recently used entries are dropped first. A cached
+// entry is refreshed when the file modification time changes.
+
+#ifndef MULTISPEECH_SOUND_CACHE_HPP
+#define MULTISPEECH_SOUND_CACHE_HPP
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "lru_cache.hpp"
+#include "hit_rate.hpp"
+
+class sound_cache
+{
+public:
+  // Decoded sound data:
+  class clip
+  {
+  public:
+    std::vector<float> samples;
+    unsigned int rate;
+    unsigned int channels;
+    std::time_t mtime;
+
+    // Total number of frames:
+    unsigned int frames(void) const;
+  };
+
+  // Get decoded sound for specified file. Empty pointer is returned
+  // when the file cannot be decoded or is too large to be cached,
+  // so the caller should play it directly from disk.
+  static boost::shared_ptr<const clip> lookup(const boost::filesystem::path& sound_file);
+
+  // Decode and store all sound files found in specified directory
+  // while there is enough room in the cache:
+  static void preload(const boost::filesystem::path& directory);
+
+  // Configurable parameters:
+  static unsigned int capacity; // in kilobytes
+  static std::string preload_path;
+
+private:
+  // Cached sounds indexed by file names:
+  static lru_cache<std::string, boost::shared_ptr<const clip> > storage;
+
+  // Usage statistics:
+  static hit_rate statistics;
+
+  // Exclusive access control:
+  static boost::mutex access;
+
+  // Read and decode sound file:
+  static boost::shared_ptr<clip> decode(const boost::filesystem::path& sound_file,
+                                        std::size_t limit);
+
+  // Log hit rate along with the cache state:
+  static void report(void);
+
+  // Memory amount required by decoded sound data:
+  static std::size_t size(const clip& data);
+
+  // Cache capacity in bytes:
+  static std::size_t limit(void);
+};
+
+#endif
@@ -18,7 +18,7 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
-#include <typeinfo>
+#include <algorithm>
 
 #include "sound_manager.hpp"
 
@@ -28,17 +28,35 @@ using namespace std;
 using namespace boost;
 
 
+// Scheduling policy names:
+static const char* const policy_names[] =
+  {
+    "queue",
+    "preempt"
+  };
+
+
+// Static data definition:
+sound_manager::policy sound_manager::scheduling[sound_manager::urgency_levels] =
+  {
+    sound_manager::preempt, // message
+    sound_manager::queue // text
+  };
+
+
 // Constructing / destroying:
 
 sound_manager::sound_manager(callback* host):
   state(idle),
   business(nothing),
-  jobs(new jobs_queue),
+  current(text),
+  jobs(new schedule),
   sounds(this->event),
   tones(this->event),
   speech(this->event),
   events(host),
-  service(boost::ref(*this))
+  service(boost::ref(*this)),
+  interactive(this)
 {
 }
 
@@ -89,21 +107,21 @@ sound_manager::execute(const tone_task& task)
 void
 sound_manager::execute(const speech_task& task)
 {
-  boost::recursive_mutex::scoped_lock lock(access);
-  if ((state == running) && !jobs->empty())
-    business = speaking;
-  if (!file_player::asynchronous)
-    sounds.stop();
-  if (!tone_generator::asynchronous)
-    tones.stop();
-  speech.stop();
-  speech.start(task);
+  interactive.cancel();
+  launch(task);
+}
+
+void
+sound_manager::execute_interactive(const speech_task& task)
+{
+  interactive.submit(task);
 }
 
 void
 sound_manager::proceed(void)
 {
   boost::recursive_mutex::scoped_lock lock(access);
+  arrange();
   if ((state == idle) && !jobs->empty())
     {
       state = running;
@@ -114,12 +132,14 @@ sound_manager::proceed(void)
 void
 sound_manager::suspend(void)
 {
+  interactive.cancel();
   boost::recursive_mutex::scoped_lock lock(access);
   mute();
   backup = jobs;
-  jobs.reset(new jobs_queue);
+  jobs.reset(new schedule);
   if ((state == running) && !backup->empty())
-    jobs->push(any());
+    jobs->queue[current].push_back(job());
+  completion.notify_all();
 }
 
 void
@@ -137,7 +157,7 @@ sound_manager::resume(void)
           event.notify_one();
           break;
         case running:
-          jobs->push(any());
+          jobs->queue[current].push_back(job());
         default:
           break;
         }
@@ -148,12 +168,17 @@ sound_manager::resume(void)
 void
 sound_manager::stop(void)
 {
+  interactive.cancel();
   boost::recursive_mutex::scoped_lock lock(access);
   mute();
-  while (!jobs->empty())
-    jobs->pop();
+  for (int level = message; level < urgency_levels; level++)
+    {
+      jobs->queue[level].clear();
+      jobs->fresh[level] = 0;
+    }
   if (state == running)
-    jobs->push(any());
+    jobs->queue[current].push_back(job());
+  completion.notify_all();
 }
 
 unsigned int
@@ -163,6 +188,14 @@ sound_manager::capacity(void)
   return jobs->size();
 }
 
+void
+sound_manager::throttle(unsigned int limit)
+{
+  boost::recursive_mutex::scoped_lock lock(access);
+  while ((state == running) && (jobs->size() > limit))
+    completion.wait(lock);
+}
+
 bool
 sound_manager::active(void)
 {
@@ -181,6 +214,7 @@ sound_manager::operator()(void)
         next_job();
       while (working())
         event.wait(lock);
+      completion.notify_all();
       if (jobs->empty())
         events->queue_done();
     }
@@ -204,50 +238,60 @@ sound_manager::die(void)
   mute();
   state = dead;
   event.notify_one();
+  completion.notify_all();
 }
 
 void
 sound_manager::next_job(void)
 {
-  if (jobs->front().empty())
-    business = nothing;
-  else if (jobs->front().type() == typeid(sound_task))
+  current = jobs->top();
+  job& task = jobs->queue[current].front();
+  switch (task.which())
     {
+    case sound_job:
       if (!file_player::asynchronous)
         {
           if (!tone_generator::asynchronous)
             tones.stop();
           speech.stop();
         }
-      sounds.start(any_cast<sound_task>(jobs->front()),
+      sounds.start(get<sound_task>(task),
                    !file_player::asynchronous || (business != playing));
       business = playing;
-    }
-  else if (jobs->front().type() == typeid(tone_task))
-    {
+      break;
+    case tone_job:
       if (!tone_generator::asynchronous)
         {
           if (!file_player::asynchronous)
             sounds.stop();
           speech.stop();
         }
-      tones.start(any_cast<tone_task>(jobs->front()),
+      tones.start(get<tone_task>(task),
                   !tone_generator::asynchronous || (business != beeping));
       business = beeping;
-    }
-  else if (jobs->front().type() == typeid(speech_task))
-    {
+      break;
+    case speech_job:
       if (!file_player::asynchronous)
         sounds.stop();
       if (!tone_generator::asynchronous)
         tones.stop();
       speech.stop();
-      speech.start(any_cast<speech_task>(jobs->front()));
+      {
+        // Let the following speech be synthesized in advance:
+        const jobs_queue& tasks = jobs->queue[current];
+        if ((tasks.size() > 1) && (tasks[1].which() == speech_job))
+          speech.start(get<speech_task>(task), get<speech_task>(tasks[1]));
+        else speech.start(get<speech_task>(task));
+      }
       business = speaking;
+      break;
+    case index_mark_job:
+      events->index_mark(get<string>(task));
+      break;
+    default:
+      business = nothing;
+      break;
     }
-  else if (jobs->front().type() == typeid(string))
-    events->index_mark(any_cast<string>(jobs->front()));
-  else business = nothing;
 }
 
 bool
@@ -256,26 +300,27 @@ sound_manager::working(void)
   bool result = false;
   if (state == running)
     {
-      if (!jobs->empty())
+      jobs_queue& tasks = jobs->queue[current];
+      if (!tasks.empty())
         switch (business)
           {
           case playing:
             if (file_player::asynchronous || !sounds.active())
-              jobs->pop();
+              tasks.pop_front();
             else result = true;
             break;
           case beeping:
             if (tone_generator::asynchronous || !tones.active())
-              jobs->pop();
+              tasks.pop_front();
             else result = true;
             break;
           case speaking:
             if (!speech.active())
-              jobs->pop();
+              tasks.pop_front();
             else result = true;
             break;
           default:
-            jobs->pop();
+            tasks.pop_front();
             break;
           }
       if (jobs->empty())
@@ -286,3 +331,88 @@ sound_manager::working(void)
     }
   return result;
 }
+
+void
+sound_manager::launch(const speech_task& task)
+{
+  boost::recursive_mutex::scoped_lock lock(access);
+  if ((state == running) && !jobs->empty())
+    business = speaking;
+  if (!file_player::asynchronous)
+    sounds.stop();
+  if (!tone_generator::asynchronous)
+    tones.stop();
+  speech.stop();
+  speech.start(task);
+}
+
+void
+sound_manager::arrange(void)
+{
+  for (int level = message; level < urgency_levels; level++)
+    if (jobs->fresh[level])
+      {
+        if ((scheduling[level] == preempt) &&
+            (state == running) && (current > level))
+          mute();
+        jobs->fresh[level] = 0;
+      }
+}
+
+
+// Job queues for all urgency classes:
+
+sound_manager::schedule::schedule(void)
+{
+  fill(fresh, fresh + urgency_levels, 0);
+}
+
+unsigned int
+sound_manager::schedule::size(void) const
+{
+  unsigned int result = 0;
+  for (int level = message; level < urgency_levels; level++)
+    result += queue[level].size();
+  return result;
+}
+
+bool
+sound_manager::schedule::empty(void) const
+{
+  for (int level = message; level < urgency_levels; level++)
+    if (!queue[level].empty())
+      return false;
+  return true;
+}
+
+sound_manager::urgency
+sound_manager::schedule::top(void) const
+{
+  for (int level = message; level < urgency_levels; level++)
+    if (!queue[level].empty())
+      return static_cast<urgency>(level);
+  return text;
+}
+
+
+// Scheduling policy names conversion:
+
+istream&
+operator>>(istream& in, sound_manager::policy& value)
+{
+  string name;
+  if (in >> name)
+    {
+      const char* const* found = find(policy_names, policy_names + (sizeof(policy_names) / sizeof(const char*)), name);
+      if (found != policy_names + (sizeof(policy_names) / sizeof(const char*)))
+        value = static_cast<sound_manager::policy>(found - policy_names);
+      else in.setstate(ios::failbit);
+    }
+  return in;
+}
+
+ostream&
+operator<<(ostream& out, sound_manager::policy value)
+{
+  return out << policy_names[value];
+}
@@ -22,15 +22,21 @@
 // in one consistent mechanism. It takes care of proper sound events
 // dispatching and provides all necessary control means to maintain
 // and manage sound producing tasks queue as well as the ones
-// to execute such tasks immediately.
+// to execute such tasks immediately. Queued jobs are divided into
+// urgency classes served in the order of their priority. Whether
+// a class interrupts the less urgent job in progress is defined
+// by configurable scheduling policy.
 
 #ifndef MULTISPEECH_SOUND_MANAGER_HPP
 #define MULTISPEECH_SOUND_MANAGER_HPP
 
 #include <string>
-#include <queue>
+#include <istream>
+#include <ostream>
+#include <utility>
 
-#include <boost/any.hpp>
+#include <boost/blank.hpp>
+#include <boost/variant.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/recursive_mutex.hpp>
@@ -39,8 +45,10 @@
 #include "file_player.hpp"
 #include "tone_generator.hpp"
 #include "loudspeaker.hpp"
+#include "coalescer.hpp"
+#include "ring_queue.hpp"
 
-class sound_manager
+class sound_manager: private coalescer::executor
 {
 public:
   // Callback interface to report events:
@@ -51,6 +59,21 @@ public:
     virtual void queue_done(void) = 0;
   };
 
+  // Job urgency classes in the order of decreasing priority:
+  enum urgency
+  {
+    message, // Short messages, such as characters and keys.
+    text, // Regular text.
+    urgency_levels // Not a class, but their number
+  };
+
+  // Scheduling policies:
+  enum policy
+  {
+    queue, // Wait until lower priority job in progress completes.
+    preempt // Interrupt lower priority job in progress.
+  };
+
   // Constructing / destroying.
   explicit sound_manager(callback* host);
   ~sound_manager(void);
@@ -59,12 +82,16 @@ public:
   // at the time of submission, this one will be added
   // to the running queue and so will be executed automatically
   // when the time comes. Otherwise actual execution
-  // should be started explicitly.
+  // should be started explicitly. Besides the sound producing tasks
+  // a string can be submitted to be reported as index mark.
+  // All jobs submitted before the next proceed() call are treated
+  // as a single submission of the specified urgency class.
   template <typename task_description>
-  void enqueue(const task_description& task)
+  void enqueue(task_description&& task, urgency level = text)
   {
     boost::recursive_mutex::scoped_lock lock(access);
-    jobs->push(boost::any(task));
+    jobs->queue[level].push_back(job(std::forward<task_description>(task)));
+    jobs->fresh[level]++;
   }
 
   // Execute specified task immediately. Other playing sounds
@@ -73,8 +100,13 @@ public:
   void execute(const tone_task& task);
   void execute(const speech_task& task);
 
+  // Execute interactive speech task, such as key echo. When such tasks
+  // are coming too frequently, superseded ones are dropped.
+  void execute_interactive(const speech_task& task);
+
   // Execute queued jobs one by one until queue exhaustion.
-  // No effect if some job is executing already.
+  // If some job is executing already, just apply scheduling
+  // policies to the new submissions.
   void proceed(void);
 
   // Stop all current sounds if any and backup the jobs queue.
@@ -91,15 +123,60 @@ public:
   // Note that a job is removed from the queue only after completion.
   unsigned int capacity(void);
 
+  // Block the caller while the queue is running and holds
+  // more than specified number of items:
+  void throttle(unsigned int limit);
+
   // Return true if any sound is currently playing.
   bool active(void);
 
   // The thread execution loop.
   void operator()(void);
 
+  // Configurable parameters:
+  static policy scheduling[urgency_levels];
+
 private:
-  // Jobs queue container.
-  typedef std::queue<boost::any> jobs_queue;
+  // Queued job. Blank value serves as a placeholder
+  // for the job being interrupted.
+  typedef boost::variant<boost::blank, sound_task, tone_task,
+                         speech_task, std::string> job;
+
+  // Job kinds in the order of variant types enumeration:
+  enum job_kind
+  {
+    placeholder,
+    sound_job,
+    tone_job,
+    speech_job,
+    index_mark_job
+  };
+
+  // Jobs queue container. Its storage is reused,
+  // so submissions do not allocate memory:
+  typedef ring_queue<job> jobs_queue;
+
+  // Job queues for all urgency classes:
+  class schedule
+  {
+  public:
+    schedule(void);
+
+    // Queued jobs:
+    jobs_queue queue[urgency_levels];
+
+    // Number of jobs submitted since last proceed() call:
+    unsigned int fresh[urgency_levels];
+
+    // Total number of queued jobs:
+    unsigned int size(void) const;
+
+    // Return true when there are no jobs at all:
+    bool empty(void) const;
+
+    // Urgency class of the most important queued jobs:
+    urgency top(void) const;
+  };
 
   // Thread states:
   enum status
@@ -124,8 +201,11 @@ private:
   // Current business in the sense of queue proceeding.
   activity business;
 
+  // Urgency class of the job in progress.
+  urgency current;
+
   // Job queues.
-  boost::shared_ptr<jobs_queue> jobs, backup;
+  boost::shared_ptr<schedule> jobs, backup;
 
   // Sound streams.
   file_player sounds;
@@ -137,16 +217,25 @@ private:
 
   // Critical data access control means.
   boost::recursive_mutex access;
-  boost::condition event;
+  boost::condition event, completion;
 
   // Thread handler.
   boost::thread service;
 
+  // Interactive tasks flood protection.
+  coalescer interactive;
+
   // Internal routines:
   void mute(void); // Mute all playing sounds if any.
   void die(void); // Make thread to break execution loop.
   void next_job(void); // Get and start the next job from the queue.
   bool working(void); // Return true if a job is in progress.
+  void arrange(void); // Apply scheduling policies to new submissions.
+  void launch(const speech_task& task); // Start speech immediately.
 };
 
+// Scheduling policy names are used in configuration:
+std::istream& operator>>(std::istream& in, sound_manager::policy& value);
+std::ostream& operator<<(std::ostream& out, sound_manager::policy value);
+
 #endif
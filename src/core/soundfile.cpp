@@ -39,7 +39,7 @@ soundfile::~soundfile(void)
 }
 
 
-// Private methods:
+// Protected methods:
 
 unsigned int
 soundfile::source_read(float* buffer, unsigned int nframes)
@@ -53,7 +53,6 @@ protected:
   // Source file description data:
   SNDFILE* source;
 
-private:
   // Retreive a chunk of audio data:
   unsigned int source_read(float* buffer, unsigned int nframes);
 
@@ -56,6 +56,39 @@ static double persistent_char_rate = 1.0;
 // Blank pattern:
 static const wregex blank_pattern(L"\\s+");
 
+// Make up speech task preparation context substituting
+// persistent values for unspecified parameters:
+static voice_params
+resolve(double volume, double rate, double pitch, double deviation,
+        punctuations::mode verbosity)
+{
+  return voice_params((volume > 0.0) ? volume : persistent_volume,
+                      (rate > 0.0) ? rate : persistent_rate,
+                      (pitch > 0.0) ? pitch : persistent_pitch,
+                      (deviation > 0.0) ? deviation : persistent_deviation,
+                      verbosity);
+}
+
+// Working storage for text preparation. Every thread has its own,
+// so the buffers grown by one request are reused by the following
+// ones without any locking:
+class preparation_buffers
+{
+public:
+  map<const char*, string> macros;
+  filter_context conditions;
+  wstring key;
+};
+static thread_local preparation_buffers scratch;
+
+// Substitute macros in a command pattern:
+static void
+substitute(string& cmd, const map<const char*, string>& macros)
+{
+  for (map<const char*, string>::const_iterator macro = macros.begin(); macro != macros.end(); ++macro)
+    replace_all(cmd, macro->first, macro->second);
+}
+
 
 // Common voice and speech parameters:
 bool speech_engine::split_caps = false;
@@ -89,7 +122,8 @@ speech_engine::speech_engine(const string& backend,
   native_sampling(sampling),
   sound_channels(channels),
   playing_deviation(deviate),
-  backend_charset(charset)
+  backend_charset(charset),
+  prepared_texts(lang)
 {
   if (lang_id::en == lang)
     language.reset(new English);
@@ -106,6 +140,7 @@ speech_engine::speech_engine(const string& backend,
   else if (lang_id::it == lang)
     language.reset(new Italian);
   else throw configuration::error("unsupported language " + string(lang) + " specified for " + backend);
+  language->prepare();
   format_macros[lang_macro] = lang;
 }
 
@@ -171,12 +206,45 @@ speech_engine::space_special_chars_mode(bool value)
 }
 
 
+// Settings snapshot:
+
+speech_engine::preferences::preferences(void):
+  volume(persistent_volume),
+  pitch(persistent_pitch),
+  rate(persistent_rate),
+  deviation(persistent_deviation),
+  char_pitch(persistent_char_pitch),
+  char_rate(persistent_char_rate),
+  split_caps(speech_engine::split_caps),
+  capitalize(speech_engine::capitalize),
+  space_special_chars(speech_engine::space_special_chars),
+  verbosity(punctuations::verbosity)
+{
+}
+
+void
+speech_engine::preferences::restore(void) const
+{
+  persistent_volume = volume;
+  persistent_pitch = pitch;
+  persistent_rate = rate;
+  persistent_deviation = deviation;
+  persistent_char_pitch = char_pitch;
+  persistent_char_rate = char_rate;
+  speech_engine::split_caps = split_caps;
+  speech_engine::capitalize = capitalize;
+  speech_engine::space_special_chars = space_special_chars;
+  punctuations::verbosity = verbosity;
+}
+
+
 // Speech queue control methods:
 
 speech_task
 speech_engine::text_task(const wstring& s, bool use_translation)
 {
-  return wrap_text(s, -1.0, -1.0, -1.0, -1.0, use_translation);
+  return wrap_text(s, resolve(-1.0, -1.0, -1.0, -1.0, punctuations::verbosity),
+                   use_translation);
 }
 
 speech_task
@@ -185,19 +253,23 @@ speech_engine::text_task(const wstring& s,
                          bool use_translation,
                          bool allpuncts)
 {
-  return wrap_text(s, voice->volume, voice->rate, voice->pitch, voice->deviation, use_translation, allpuncts);
+  return wrap_text(s, resolve(voice->volume, voice->rate, voice->pitch, voice->deviation,
+                              voice->punctuations_mode),
+                   use_translation, allpuncts);
 }
 
 speech_task
 speech_engine::letter_task(wstring s)
 {
-  return wrap_letter(s, -1.0, persistent_char_rate, persistent_char_pitch, 0.0);
+  return wrap_letter(s, -1.0, persistent_char_rate, persistent_char_pitch, 0.0,
+                     punctuations::verbosity);
 }
 
 speech_task
 speech_engine::letter_task(wstring s, voice_params* voice)
 {
-  return wrap_letter(s, voice->volume, voice->rate, voice->pitch, voice->deviation);
+  return wrap_letter(s, voice->volume, voice->rate, voice->pitch, voice->deviation,
+                     voice->punctuations_mode);
 }
 
 speech_task
@@ -218,10 +290,11 @@ speech_engine::command(const string& pattern)
 }
 
 void
-speech_engine::voicify(double rate, double pitch)
+speech_engine::voicify(map<const char*, string>& macros,
+                       double rate, double pitch) const
 {
-  format_macros[pitch_macro] = lexical_cast<string>(pitch);
-  format_macros[rate_macro] = lexical_cast<string>(rate);
+  macros[pitch_macro] = lexical_cast<string>(pitch);
+  macros[rate_macro] = lexical_cast<string>(rate);
 }
 
 void
@@ -241,14 +314,13 @@ speech_engine::getvoiceid(const char* lang, const map<const char*, const string*
 
 speech_task
 speech_engine::wrap_text(const wstring& s,
-                         double volume, double rate,
-                         double pitch, double deviation,
+                         const voice_params& context,
                          bool use_translation,
                          bool allpuncts)
 {
   pipeline::script commands;
-  pair<string, string> fmt;
-  wstring prepared;
+  map<const char*, string>& macros = scratch.macros;
+  string text;
   double freq = numeric_cast<double>(native_sampling);
   speech_task::details playing_params;
 
@@ -257,66 +329,77 @@ speech_engine::wrap_text(const wstring& s,
     {
       if (format != soundfile::autodetect)
         {
-          freq /= (deviation > 0.0) ? deviation : persistent_deviation;
+          freq /= context.deviation;
           playing_params.sound.sampling = numeric_cast<unsigned int>(nearbyint(freq));
           playing_params.sound.channels = sound_channels;
         }
-      else playing_params.deviation = (deviation > 0.0) ? deviation : persistent_deviation;
-      format_macros[freq_macro] = lexical_cast<string>(native_sampling);
+      else playing_params.deviation = context.deviation;
+      macros[freq_macro] = lexical_cast<string>(native_sampling);
     }
   else
     {
       playing_params.sound.sampling = native_sampling;
       playing_params.sound.channels = sound_channels;
-      freq *= (deviation > 0.0) ? deviation : persistent_deviation;
-      format_macros[freq_macro] = lexical_cast<string>(numeric_cast<unsigned int>(nearbyint(freq)));
+      freq *= context.deviation;
+      macros[freq_macro] = lexical_cast<string>(numeric_cast<unsigned int>(nearbyint(freq)));
     }
-  voicify(language->settings.rate * ((rate > 0.0) ? rate : persistent_rate),
-          language->settings.pitch * ((pitch > 0.0) ? pitch : persistent_pitch));
+  voicify(macros,
+          language->settings.rate * context.rate,
+          language->settings.pitch * context.pitch);
 
   // Make up the TTS script.
   BOOST_FOREACH(string cmd, command_patterns)
     {
-      BOOST_FOREACH(fmt, format_macros)
-        replace_all(cmd, fmt.first, fmt.second);
+      substitute(cmd, format_macros);
+      substitute(cmd, macros);
       commands.push(cmd);
     }
 
-  // Prepare the text.
+  // Prepare the text. The result depends only on the text itself,
+  // punctuations mode and translation usage, so it can be cached.
   if (!s.empty())
     {
-      punctuations::mode preserve = punctuations::verbosity;
-      if (allpuncts)
-        punctuations::verbosity = punctuations::all;
-      if (use_translation)
+      filter_context& conditions = scratch.conditions;
+      conditions.verbosity = allpuncts ? punctuations::all : context.punctuations_mode;
+      wstring& key = scratch.key;
+      key.assign(1, static_cast<wchar_t>(conditions.verbosity));
+      key += use_translation ? L'+' : L'-';
+      key += s;
+      if (!prepared_texts.lookup(key, text))
         {
-          prepared = language->translate(s);
-          if (prepared.empty())
-            prepared = language->filter(s);
+          wstring prepared;
+          if (use_translation)
+            {
+              const wchar_t* translation = language->translate(s);
+              if (translation)
+                prepared = translation;
+              else prepared = language->filter(s, conditions);
+            }
+          else prepared = language->filter(s, conditions);
+          if (!prepared.empty())
+            {
+              prepared = regex_replace(prepared, blank_pattern, L" ");
+              if (!extra_fixes.empty())
+                prepared = extra_fixes.process(prepared, conditions);
+              trim(prepared);
+            }
+          text = extern_string(prepared, backend_charset);
+          prepared_texts.store(key, text);
         }
-      else prepared = language->filter(s);
-      punctuations::verbosity = preserve;
-    }
-
-  if (!prepared.empty())
-    {
-      prepared = regex_replace(prepared, blank_pattern, L" ");
-      if (!extra_fixes.empty())
-        prepared = extra_fixes.process(prepared);
-      trim(prepared);
     }
 
   // Make up and return complete task description.
-  return speech_task(extern_string(prepared, backend_charset),
-                     commands, format, playing_params,
-                     ((volume > 0) ? volume : persistent_volume) * language->settings.volume,
+  return speech_task(text,
+                     std::move(commands), format, playing_params,
+                     context.volume * language->settings.volume,
                      language->settings.acceleration);
 }
 
 speech_task
 speech_engine::wrap_letter(wstring s,
                            double volume, double rate,
-                           double pitch, double deviation)
+                           double pitch, double deviation,
+                           punctuations::mode verbosity)
 {
   if (s.length() == 1)
     {
@@ -324,5 +407,8 @@ speech_engine::wrap_letter(wstring s,
         pitch *= language->settings.caps_factor;
       else s[0] = toupper(s[0], locale());
     }
-  return wrap_text(s, volume, rate * language->settings.char_rate, pitch * language->settings.char_pitch, deviation, true, true);
+  return wrap_text(s, resolve(volume, rate * language->settings.char_rate,
+                              pitch * language->settings.char_pitch,
+                              deviation, verbosity),
+                   true, true);
 }
@@ -42,7 +42,11 @@
 // method voicify() that must be implemented in derived classes:
 // "%pitch" and "%rate". These macro specifications
 // are to be replaced by the values defining voice pitch
-// and speech rate in the backend's sensible way.
+// and speech rate in the backend's sensible way. This method
+// places them into the macro set of a particular request
+// instead of the format_macros, so it must not change the object.
+// The request macro set is reused by the following requests,
+// so every macro placed there must be defined on each call.
 //
 // Additional macros can be easily added by derived classes if needed.
 // All necessary information for it can be obtained from the respective
@@ -74,6 +78,7 @@
 #include "language_description.hpp"
 #include "voice_params.hpp"
 #include "text_filter.hpp"
+#include "text_cache.hpp"
 
 class speech_engine
 {
@@ -109,6 +114,24 @@ public:
   static void capitalize_mode(bool value = false);
   static void space_special_chars_mode(bool value = false);
 
+  // Snapshot of all the parameters and modes set above along with
+  // the punctuations verbosity. It is taken at construction
+  // and can be put back later, so daemon sessions
+  // do not affect each other's settings:
+  class preferences
+  {
+  public:
+    preferences(void);
+
+    // Make these settings current:
+    void restore(void) const;
+
+  private:
+    double volume, pitch, rate, deviation, char_pitch, char_rate;
+    bool split_caps, capitalize, space_special_chars;
+    punctuations::mode verbosity;
+  };
+
   // Prepare speech task:
   speech_task text_task(const std::wstring& s,
                         bool use_translation = false);
@@ -139,7 +162,8 @@ protected:
   // Make up voice parameters for backend. The base implementation
   // passes them as is. If a backend needs some special treatment
   // this method should be redefined in derived classes.
-  virtual void voicify(double rate, double pitch = 1.0);
+  virtual void voicify(std::map<const char*, std::string>& macros,
+                       double rate, double pitch = 1.0) const;
 
   // Change native sampling frequency:
   void sampling(unsigned int value);
@@ -181,15 +205,21 @@ private:
   // Shell command patterns to make up a TTS script:
   std::list<std::string> command_patterns;
 
-  // Construct speech task according to specified parameters:
+  // Recently prepared texts in the backend charset:
+  text_cache prepared_texts;
+
+  // Construct speech task according to specified parameters.
+  // The text is prepared in the given context with all parameters
+  // already resolved, so no shared state is changed and several
+  // tasks can be prepared concurrently.
   speech_task wrap_text(const std::wstring& s,
-                        double volume, double rate,
-                        double pitch, double deviation,
+                        const voice_params& context,
                         bool use_translation = false,
                         bool allpuncts = false);
   speech_task wrap_letter(std::wstring s,
                           double volume, double rate,
-                          double pitch, double deviation);
+                          double pitch, double deviation,
+                          punctuations::mode verbosity);
 };
 
 #endif
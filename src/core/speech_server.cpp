@@ -28,10 +28,12 @@
 #include <exception>
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/thread/reverse_lock.hpp>
 
 #include "speech_server.hpp"
 
 #include "config.hpp"
+#include "sound_cache.hpp"
 
 using namespace std;
 using namespace boost;
@@ -59,14 +61,42 @@ bool speech_server::spd_use_voice_language = true;
 bool speech_server::spd_accept_explicit_language = true;
 bool speech_server::spd_ignore_unknown_voice = false;
 bool speech_server::spd_support_index_marks = true;
+unsigned int speech_server::spd_stream_threshold = 0;
+
+// Daemon mode is off by default:
+string speech_server::frontend_socket;
+string speech_server::spd_socket;
+
+// Daemon sessions take turns performing commands:
+boost::mutex speech_server::engines_access;
 
 
 // Construct / destroy:
 
-speech_server::speech_server(void):
+speech_server::speech_server(int input, int output, polyglot* linguist):
+  io(input, output),
+  own_speechmaster(linguist ? NULL : new polyglot),
+  speechmaster(linguist ? *linguist : *own_speechmaster),
   soundmaster(this),
-  exit_status(EXIT_SUCCESS)
+  exit_status(EXIT_SUCCESS),
+  language_choice(speechmaster.current_choice()),
+  command_lock(NULL)
 {
+  // Sound cache is shared by daemon sessions:
+  static bool preloaded = false;
+  if (!preloaded)
+    {
+      sound_cache::preload(sound_cache::preload_path);
+      preloaded = true;
+    }
+
+  // Every daemon session starts with the configured settings
+  // rather than ones left by another session. They are taken
+  // when the first session is constructed:
+  static const polyglot::choice initial_language(language_choice);
+  static const speech_engine::preferences initial_preferences(preferences);
+  language_choice = initial_language;
+  preferences = initial_preferences;
 }
 
 speech_server::~speech_server(void)
@@ -80,7 +110,6 @@ void
 speech_server::communication_reset(void)
 {
   cmd.erase();
-  accumulator.str("");
 }
 
 bool
@@ -89,25 +118,29 @@ speech_server::do_nothing(void)
   return true;
 }
 
+void
+speech_server::wait_queue(unsigned int limit)
+{
+  // Called from perform_command(), so the guard is taken already:
+  save_settings();
+  {
+    boost::reverse_lock<boost::mutex::scoped_lock> unlocked(*command_lock);
+    soundmaster.throttle(limit);
+  }
+  restore_settings();
+}
+
 
 // Public methods:
 
 int
 speech_server::run(void)
 {
-  do
-    try
-      {
-        get_command();
-      }
-    catch (std::exception& failure)
-      {
-        communication_reset();
-        log << failure.what() << endl;
-        if (verbose)
-          cerr << failure.what() << endl;
-      }
-  while (perform_command());
+  // Shared speech engines are warmed up by the daemon:
+  if (own_speechmaster)
+    speechmaster.warm_up();
+  while (step());
+  io.flush();
   soundmaster.stop();
   return exit_status;
 }
@@ -130,6 +163,43 @@ speech_server::redirect_stderr(const char* file)
 
 // Private methods:
 
+bool
+speech_server::step(void)
+{
+  try
+    {
+      get_command();
+    }
+  catch (std::exception& failure)
+    {
+      communication_reset();
+      log << failure.what() << endl;
+      if (verbose)
+        cerr << failure.what() << endl;
+    }
+  boost::mutex::scoped_lock lock(engines_access);
+  command_lock = &lock;
+  restore_settings();
+  bool proceed = perform_command();
+  save_settings();
+  command_lock = NULL;
+  return proceed;
+}
+
+void
+speech_server::restore_settings(void)
+{
+  speechmaster.restore(language_choice);
+  preferences.restore();
+}
+
+void
+speech_server::save_settings(void)
+{
+  language_choice = speechmaster.current_choice();
+  preferences = speech_engine::preferences();
+}
+
 void
 speech_server::index_mark(const string& name)
 {
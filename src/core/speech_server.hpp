@@ -23,22 +23,41 @@
 // The derived classes should define actual command set and input
 // method by implementing virtual methods declared in private section.
 
+// A speech server normally talks to its client via standard input
+// and output and owns the speech engines. In daemon mode several
+// servers are run as sessions in one process, each in its own thread
+// talking via its own socket, and all of them use the same speech
+// engines. Commands are performed by one session at a time, and
+// the language choice along with the voice and speech settings
+// are kept for each session separately. Every session has its own
+// sound manager though, so its queue, stop and pause commands
+// and index marks do not interfere with other clients. The audio
+// system mixes the sound streams of sessions speaking at once.
+
 #ifndef MULTISPEECH_SPEECH_SERVER_HPP
 #define MULTISPEECH_SPEECH_SERVER_HPP
 
+#include <unistd.h>
+
 #include <string>
-#include <sstream>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <bobcat/syslogstream>
 
+#include "channel.hpp"
 #include "polyglot.hpp"
 #include "sound_manager.hpp"
 
 class speech_server: private sound_manager::callback
 {
 protected:
-  // Object constructor:
-  speech_server(void);
+  // Object constructor. The server gets its own speech engines
+  // unless shared ones are specified:
+  explicit speech_server(int input = STDIN_FILENO,
+                         int output = STDOUT_FILENO,
+                         polyglot* linguist = NULL);
 
 public:
   // Destructor is made public to accommodate smart pointers:
@@ -75,6 +94,12 @@ public:
   static bool spd_accept_explicit_language;
   static bool spd_ignore_unknown_voice;
   static bool spd_support_index_marks;
+  static unsigned int spd_stream_threshold;
+
+  // Daemon sockets for both protocols. Empty path means
+  // that daemon mode is not used:
+  static std::string frontend_socket;
+  static std::string spd_socket;
 
   // Redirect standard error output to the specified file or to /dev/null.
   // Return true on success.
@@ -87,18 +112,46 @@ protected:
   // Dummy command executor:
   bool do_nothing(void);
 
-  // Data read from input:
+  // Wait until no more than specified number of items remain
+  // in the speech queue. Other daemon sessions may perform
+  // their commands meanwhile:
+  void wait_queue(unsigned int limit);
+
+  // Client communication channel:
+  channel io;
+
+  // Command read from input:
   std::string cmd;
-  std::ostringstream accumulator;
+
+  // Speech engines owned by the server, if any:
+  boost::scoped_ptr<polyglot> own_speechmaster;
 
   // Speech and sounds:
-  polyglot speechmaster;
+  polyglot& speechmaster;
   sound_manager soundmaster;
 
   // Exit status:
   int exit_status;
 
 private:
+  // Language and settings chosen in the session:
+  polyglot::choice language_choice;
+  speech_engine::preferences preferences;
+
+  // Shared speech engines and settings guard:
+  static boost::mutex engines_access;
+
+  // The guard lock held while a command is performed:
+  boost::mutex::scoped_lock* command_lock;
+
+  // Make session settings current and save them back:
+  void restore_settings(void);
+  void save_settings(void);
+
+  // Get and perform one command. Returns false
+  // if execution should be finished.
+  bool step(void);
+
   // Implement these methods to take over queue events.
   // Default implementation does nothing.
   void index_mark(const std::string& name);
@@ -18,8 +18,16 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+#include <cerrno>
+#include <cctype>
 #include <string>
+#include <vector>
+#include <algorithm>
 
+#include <iconv.h>
+
+#include <boost/predef/other/endian.h>
+#include <boost/locale/info.hpp>
 #include <boost/locale/encoding.hpp>
 
 #include "strcvt.hpp"
@@ -28,27 +36,227 @@ using namespace std;
 using namespace boost::locale::conv;
 
 
+// Charset converters registry:
+map<string, boost::shared_ptr<charset_converter> > charset_converter::registry;
+boost::mutex charset_converter::registry_access;
+
+// Native wide character encoding for iconv. The "WCHAR_T" name
+// is known to glibc only, so it is spelled out explicitly:
+#if BOOST_ENDIAN_BIG_BYTE
+static const char* const wide_charset = (sizeof(wchar_t) == 4) ? "UTF-32BE" : "UTF-16BE";
+#else
+static const char* const wide_charset = (sizeof(wchar_t) == 4) ? "UTF-32LE" : "UTF-16LE";
+#endif
+
+// Failure and invalid descriptor codes returned by iconv:
+static const size_t iconv_failure = static_cast<size_t>(-1);
+static const iconv_t iconv_invalid = reinterpret_cast<iconv_t>(-1);
+
+// Run iconv over the whole input including the final flush,
+// so stateful encodings are properly terminated. The output buffer
+// grows as needed. Input units that cannot be converted are skipped.
+// Returns the number of produced bytes.
+template <typename unit>
+static size_t
+convert(iconv_t cd, const char* source, size_t length, size_t step,
+        vector<unit>& buffer)
+{
+  char* in = const_cast<char*>(source);
+  size_t in_left = length;
+  char* out = reinterpret_cast<char*>(&buffer[0]);
+  size_t out_left = buffer.size() * sizeof(unit);
+  iconv(cd, NULL, NULL, NULL, NULL);
+  while (true)
+    {
+      bool flushing = !in_left;
+      size_t result = flushing ?
+        iconv(cd, NULL, NULL, &out, &out_left) :
+        iconv(cd, &in, &in_left, &out, &out_left);
+      if (result != iconv_failure)
+        {
+          if (flushing)
+            break;
+        }
+      else if (errno == E2BIG)
+        {
+          size_t done = buffer.size() * sizeof(unit) - out_left;
+          buffer.resize(buffer.size() * 2);
+          out = reinterpret_cast<char*>(&buffer[0]) + done;
+          out_left = buffer.size() * sizeof(unit) - done;
+        }
+      else if (flushing)
+        break;
+      else
+        {
+          // Skip invalid, incomplete or unconvertible input:
+          size_t skip = min(step, in_left);
+          in += skip;
+          in_left -= skip;
+        }
+    }
+  return buffer.size() * sizeof(unit) - out_left;
+}
+
+
+// iconv descriptors for particular charset:
+
+class charset_converter::descriptors
+{
+public:
+  explicit descriptors(const string& charset);
+  ~descriptors(void);
+
+  iconv_t decoder, encoder;
+};
+
+charset_converter::descriptors::descriptors(const string& charset):
+  decoder(iconv_open(wide_charset, charset.c_str())),
+  encoder(iconv_open(charset.c_str(), wide_charset))
+{
+  if ((decoder == iconv_invalid) || (encoder == iconv_invalid))
+    {
+      if (decoder != iconv_invalid)
+        iconv_close(decoder);
+      if (encoder != iconv_invalid)
+        iconv_close(encoder);
+      throw invalid_charset_error(charset);
+    }
+}
+
+charset_converter::descriptors::~descriptors(void)
+{
+  iconv_close(decoder);
+  iconv_close(encoder);
+}
+
+
+// charset_converter members:
+
+charset_converter::charset_converter(const string& charset):
+  iconv_means(new descriptors(charset)),
+  utf8(false),
+  ascii_compatible(false)
+{
+  string name;
+  for (string::const_iterator c = charset.begin(); c != charset.end(); ++c)
+    if (isalnum(static_cast<unsigned char>(*c)))
+      name += tolower(static_cast<unsigned char>(*c));
+  utf8 = (name == "utf8");
+
+  // Check if ASCII characters are represented by themselves:
+  string sample;
+  for (int c = 1; c < 0x80; c++)
+    sample += static_cast<char>(c);
+  wstring decoded(decode(sample));
+  ascii_compatible = (decoded.length() == sample.length()) &&
+    equal(sample.begin(), sample.end(), decoded.begin()) &&
+    (encode(decoded) == sample);
+}
+
+charset_converter::~charset_converter(void)
+{
+}
+
+charset_converter&
+charset_converter::get(const string& charset)
+{
+  boost::mutex::scoped_lock lock(registry_access);
+  boost::shared_ptr<charset_converter>& item = registry[charset];
+  if (!item)
+    {
+      try
+        {
+          item.reset(new charset_converter(charset));
+        }
+      catch (...)
+        {
+          registry.erase(charset);
+          throw;
+        }
+    }
+  return *item;
+}
+
+charset_converter&
+charset_converter::get(const locale& charset_holder)
+{
+  return get(use_facet<boost::locale::info>(charset_holder).encoding());
+}
+
+wstring
+charset_converter::decode(const string& s)
+{
+  if (ascii_compatible && ascii(s))
+    return wstring(s.begin(), s.end());
+  vector<wchar_t> buffer(s.length() + 1);
+  boost::mutex::scoped_lock lock(access);
+  size_t produced = convert(iconv_means->decoder, s.data(), s.length(), 1, buffer);
+  return wstring(&buffer[0], produced / sizeof(wchar_t));
+}
+
+string
+charset_converter::encode(const wstring& s)
+{
+  if (ascii_compatible && ascii(s))
+    return string(s.begin(), s.end());
+  if (utf8)
+    return utf_to_utf<char>(s);
+  vector<char> buffer(s.length() * 4 + 16);
+  boost::mutex::scoped_lock lock(access);
+  size_t produced = convert(iconv_means->encoder,
+                            reinterpret_cast<const char*>(s.data()),
+                            s.length() * sizeof(wchar_t), sizeof(wchar_t),
+                            buffer);
+  return string(&buffer[0], produced);
+}
+
+bool
+charset_converter::ascii(const string& s)
+{
+  // Escape and shift codes switch state in the 7-bit stateful
+  // encodings, such as ISO-2022-JP, so they must go through iconv:
+  for (string::const_iterator c = s.begin(); c != s.end(); ++c)
+    if ((static_cast<unsigned char>(*c) & 0x80) ||
+        (*c == '\x1b') || (*c == '\x0e') || (*c == '\x0f'))
+      return false;
+  return true;
+}
+
+bool
+charset_converter::ascii(const wstring& s)
+{
+  for (wstring::const_iterator c = s.begin(); c != s.end(); ++c)
+    if (static_cast<unsigned int>(*c) >= 0x80)
+      return false;
+  return true;
+}
+
+
+// intern_string members:
+
 intern_string::intern_string(const string& s, const locale& charset_holder):
-  wstring(to_utf<wchar_t>(s, charset_holder))
+  wstring(charset_converter::get(charset_holder).decode(s))
 {
 }
 
 intern_string::intern_string(const string& s, const string& charset):
   wstring(charset.empty() ?
-          to_utf<wchar_t>(s, locale()) :
-          to_utf<wchar_t>(s, charset))
+          charset_converter::get(locale()).decode(s) :
+          charset_converter::get(charset).decode(s))
 {
 }
 
 
+// extern_string members:
+
 extern_string::extern_string(const wstring& s, const locale& charset_holder):
-  string(from_utf(s, charset_holder))
+  string(charset_converter::get(charset_holder).encode(s))
 {
 }
 
 extern_string::extern_string(const wstring& s, const string& charset):
   string(charset.empty() ?
-         from_utf(s, locale()) :
-         from_utf(s, charset))
+         charset_converter::get(locale()).encode(s) :
+         charset_converter::get(charset).encode(s))
 {
 }
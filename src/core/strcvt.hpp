@@ -26,6 +26,51 @@
 
 #include <string>
 #include <locale>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+// Charset converter. Converters are opened once for every charset
+// and kept for reuse. Pure ASCII text is just copied for ASCII
+// compatible charsets and UTF-8 output is produced directly,
+// so iconv is used only when it is really needed.
+class charset_converter
+{
+public:
+  // Get converter for specified charset name or for the charset
+  // of specified locale:
+  static charset_converter& get(const std::string& charset);
+  static charset_converter& get(const std::locale& charset_holder);
+
+  // Destructor is made public to accommodate smart pointers:
+  ~charset_converter(void);
+
+  // Perform conversion. Characters that cannot be converted
+  // are skipped:
+  std::wstring decode(const std::string& s);
+  std::string encode(const std::wstring& s);
+
+private:
+  // Open iconv descriptors for specified charset:
+  explicit charset_converter(const std::string& charset);
+
+  // Converters registry:
+  static std::map<std::string, boost::shared_ptr<charset_converter> > registry;
+  static boost::mutex registry_access;
+
+  // Conversion means. The iconv descriptors are kept
+  // in the implementation:
+  class descriptors;
+  boost::scoped_ptr<descriptors> iconv_means;
+  bool utf8, ascii_compatible;
+  boost::mutex access;
+
+  // Check if the text is pure ASCII:
+  static bool ascii(const std::string& s);
+  static bool ascii(const std::wstring& s);
+};
 
 // Initialize wide character string from ordinary string decoding it
 // by the way according to specified charset.
@@ -0,0 +1,189 @@
+// stream_buffer.cpp -- Pipe output buffering implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#include <cerrno>
+
+#include "stream_buffer.hpp"
+
+using namespace std;
+
+
+// Data is read from the source by chunks of this size:
+static const size_t chunk_size = 65536;
+
+// Close file descriptor if it is open:
+static void
+release_fd(int& fd)
+{
+  if (fd >= 0)
+    {
+      close(fd);
+      fd = -1;
+    }
+}
+
+
+// Construct / destroy:
+
+stream_buffer::stream_buffer(int fd):
+  source(-1),
+  sent(0),
+  released(false),
+  alive(true)
+{
+  // The descriptors must not be inherited by speech backends
+  // started later, otherwise the consumer would never see
+  // the end of stream until they exit:
+  outlet[0] = outlet[1] = wakeup[0] = wakeup[1] = -1;
+  if (fd >= 0)
+    source = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (pipe2(outlet, O_CLOEXEC))
+    outlet[0] = outlet[1] = -1;
+  else fcntl(outlet[1], F_SETFL, O_NONBLOCK);
+  if (pipe2(wakeup, O_CLOEXEC | O_NONBLOCK))
+    wakeup[0] = wakeup[1] = -1;
+  if ((source >= 0) && (outlet[0] >= 0) && (wakeup[0] >= 0))
+    pump = boost::thread(boost::ref(*this));
+}
+
+stream_buffer::~stream_buffer(void)
+{
+  {
+    boost::mutex::scoped_lock lock(access);
+    alive = false;
+  }
+  notify();
+  if (pump.joinable())
+    pump.join();
+  release_fd(source);
+  release_fd(outlet[0]);
+  release_fd(outlet[1]);
+  release_fd(wakeup[0]);
+  release_fd(wakeup[1]);
+}
+
+
+// Public methods:
+
+int
+stream_buffer::release(void)
+{
+  {
+    boost::mutex::scoped_lock lock(access);
+    released = true;
+  }
+  notify();
+  return pump.joinable() ? outlet[0] : -1;
+}
+
+void
+stream_buffer::operator()(void)
+{
+  while (true)
+    {
+      bool sink;
+      {
+        boost::mutex::scoped_lock lock(access);
+        if (!alive)
+          break;
+        sink = released;
+      }
+
+      // Pass the end of stream to the consumer when all is sent:
+      if (sink && (sent == data.size()))
+        {
+          data.clear();
+          sent = 0;
+          if (source < 0)
+            {
+              release_fd(outlet[1]);
+              break;
+            }
+        }
+
+      pollfd events[3];
+      nfds_t watched = 0;
+      events[watched].fd = wakeup[0];
+      events[watched++].events = POLLIN;
+      if (source >= 0)
+        {
+          events[watched].fd = source;
+          events[watched++].events = POLLIN;
+        }
+      if (sink && (sent < data.size()))
+        {
+          events[watched].fd = outlet[1];
+          events[watched++].events = POLLOUT;
+        }
+      if (poll(events, watched, -1) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          break;
+        }
+
+      for (nfds_t i = 0; i < watched; i++)
+        if (!events[i].revents)
+          continue;
+        else if (events[i].fd == wakeup[0])
+          {
+            char signal[16];
+            while (read(wakeup[0], signal, sizeof(signal)) > 0);
+          }
+        else if (events[i].fd == source)
+          {
+            size_t stored = data.size();
+            data.resize(stored + chunk_size);
+            ssize_t obtained = read(source, &data[stored], chunk_size);
+            data.resize(stored + ((obtained > 0) ? obtained : 0));
+            if (!obtained || ((obtained < 0) && (errno != EINTR)))
+              release_fd(source);
+          }
+        else
+          {
+            ssize_t written = write(outlet[1], &data[sent], data.size() - sent);
+            if (written > 0)
+              sent += written;
+            else if ((written < 0) && (errno != EAGAIN) && (errno != EINTR))
+              {
+                // The consumer is gone, so nothing is to be sent anymore:
+                release_fd(source);
+                sent = data.size();
+              }
+          }
+    }
+}
+
+
+// Private methods:
+
+void
+stream_buffer::notify(void)
+{
+  // When the pipe is full, a wakeup is pending already,
+  // so the write failure does not matter:
+  char signal = 0;
+  if ((wakeup[1] >= 0) && (write(wakeup[1], &signal, 1) < 0))
+    return;
+}
@@ -0,0 +1,78 @@
+// stream_buffer.hpp -- Pipe output buffering interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The stream_buffer class reads a pipe by a dedicated thread
+// as fast as the data comes and keeps it in memory, so the process
+// writing there never waits for the consumer. When the consumer
+// is ready, it obtains another file descriptor to read the collected
+// data from followed by the rest of the stream. Thus a speech
+// backend can synthesize the whole text while the previous one
+// is still playing.
+
+#ifndef MULTISPEECH_STREAM_BUFFER_HPP
+#define MULTISPEECH_STREAM_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+class stream_buffer
+{
+public:
+  // Start reading specified file descriptor. It is duplicated,
+  // so the caller may close its own copy at any time.
+  explicit stream_buffer(int fd);
+
+  // Stop reading and release all resources including
+  // the descriptor returned by release():
+  ~stream_buffer(void);
+
+  // Get file descriptor to read the stream from. It remains valid
+  // until the object is destroyed:
+  int release(void);
+
+  // The thread execution loop.
+  void operator()(void);
+
+private:
+  // Data source and the pipe passing it to the consumer:
+  int source, outlet[2];
+
+  // Pipe used to wake up the thread:
+  int wakeup[2];
+
+  // Collected data and the amount already passed to the consumer:
+  std::vector<char> data;
+  std::size_t sent;
+
+  // Control flags:
+  bool released, alive;
+  boost::mutex access;
+
+  // Thread handler.
+  boost::thread pump;
+
+  // Wake the thread up to check control flags:
+  void notify(void);
+};
+
+#endif
@@ -0,0 +1,86 @@
+// text_cache.cpp -- Prepared speech texts cache implementation
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <sstream>
+
+#include "text_cache.hpp"
+
+using namespace std;
+
+
+// Static data definition:
+unsigned int text_cache::capacity = 256;
+
+
+// Object construction:
+
+text_cache::text_cache(const char* label):
+  statistics(string(label) + " text cache")
+{
+}
+
+
+// Public methods:
+
+bool
+text_cache::lookup(const wstring& key, string& text)
+{
+  if (!capacity)
+    return false;
+  boost::mutex::scoped_lock lock(access);
+  const string* cached = storage.find(key);
+  if (cached)
+    text = *cached;
+  if (statistics.count(cached))
+    report();
+  return cached;
+}
+
+void
+text_cache::store(const wstring& key, const string& text)
+{
+  boost::mutex::scoped_lock lock(access);
+  storage.store(key, text, size(key, text), limit());
+}
+
+
+// Private methods:
+
+void
+text_cache::report(void)
+{
+  ostringstream details;
+  details << storage.entries() << " entries, "
+          << (storage.occupied() >> 10) << "K occupied";
+  statistics.report(details.str());
+}
+
+size_t
+text_cache::size(const wstring& key, const string& text)
+{
+  // The key is kept twice: in the index and in the usage list.
+  return (key.length() * sizeof(wchar_t) * 2) + text.length();
+}
+
+size_t
+text_cache::limit(void)
+{
+  return static_cast<size_t>(capacity) << 10;
+}
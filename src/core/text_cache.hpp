@@ -0,0 +1,74 @@
+// text_cache.hpp -- Prepared speech texts cache interface
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The text_cache class keeps recently prepared speech texts,
+// so the strings repeated again and again, such as screen reader
+// prompts, are passed to the backend without any text processing.
+// Each speech backend has its own cache. The key comprises all
+// conditions the preparation depends on along with the original text.
+// Total memory consumption of every cache is limited by configurable
+// capacity. Least recently used entries are dropped first.
+
+#ifndef MULTISPEECH_TEXT_CACHE_HPP
+#define MULTISPEECH_TEXT_CACHE_HPP
+
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+#include "lru_cache.hpp"
+#include "hit_rate.hpp"
+
+class text_cache
+{
+public:
+  // Object constructor. The label is used in the statistics report.
+  explicit text_cache(const char* label);
+
+  // Find prepared text for specified key. Returns false on miss.
+  bool lookup(const std::wstring& key, std::string& text);
+
+  // Put prepared text into the cache:
+  void store(const std::wstring& key, const std::string& text);
+
+  // Configurable parameters:
+  static unsigned int capacity; // in kilobytes
+
+private:
+  // Prepared texts indexed by keys:
+  lru_cache<std::wstring, std::string> storage;
+
+  // Usage statistics:
+  hit_rate statistics;
+
+  // Exclusive access control:
+  boost::mutex access;
+
+  // Log hit rate along with the cache state:
+  void report(void);
+
+  // Memory amount required by an entry:
+  static std::size_t size(const std::wstring& key, const std::string& text);
+
+  // Cache capacity in bytes:
+  static std::size_t limit(void);
+};
+
+#endif
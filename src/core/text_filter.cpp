@@ -18,27 +18,39 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+#include <cwchar>
+#include <cwctype>
 #include <string>
-#include <sstream>
 #include <vector>
-#include <map>
+#include <utility>
+#include <algorithm>
 
-#include <boost/foreach.hpp>
 #include <boost/regex.hpp>
 #include <boost/locale.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/regex_find_format.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "text_filter.hpp"
 
 using namespace std;
 using namespace boost;
-using namespace boost::iostreams;
 using namespace boost::algorithm;
 using namespace boost::locale;
 
 
+// filter_stage members:
+
+filter_stage::~filter_stage(void)
+{
+}
+
+unsigned int
+filter_stage::passes(void) const
+{
+  return 1;
+}
+
+
 // case_conversion members:
 
 case_conversion::case_conversion(mode md):
@@ -46,17 +58,22 @@ case_conversion::case_conversion(mode md):
 {
 }
 
-wstring
-case_conversion::do_filter(const wstring& s)
+void
+case_conversion::apply(const wstring& src, wstring& dst,
+                       filter_context& context) const
 {
   switch (conversion_mode)
     {
     case lowercase:
-      return to_lower(s);
+      dst = to_lower(src);
+      break;
     case uppercase:
-      return to_upper(s);
+      dst = to_upper(src);
+      break;
+    default:
+      dst = src;
+      break;
     }
-  return s;
 }
 
 
@@ -65,9 +82,19 @@ case_conversion::do_filter(const wstring& s)
 const wstring punctuations::char_list(L"!'?,.;:-@#$%^&*_()+=[]{}\\|\"/`~<>");
 punctuations::mode punctuations::verbosity = punctuations::some;
 
-punctuations::punctuations(const vector<const wchar_t*>& pronunciations_list):
-  pronunciation(pronunciations_list)
+punctuations::punctuations(const wchar_t* const (&pronunciations_list)[count]):
+  pronunciation(char_list.length())
 {
+  for (unsigned int code = 0; code < table_size; code++)
+    position[code] = -1;
+  for (unsigned int i = 0; i < char_list.length(); i++)
+    {
+      position[char_list[i]] = i;
+      pronunciation[i] = pronunciations_list[i];
+      for (unsigned int j = i + 1; j < char_list.length(); j++)
+        if (pronunciation[i].find(char_list[j]) != wstring::npos)
+          replace_all(pronunciation[i], char_list.substr(j, 1), pronunciations_list[j]);
+    }
 }
 
 punctuations::mode
@@ -99,36 +126,96 @@ punctuations::set_mode(wchar_t wc)
   verbosity = from_wchar(wc);
 }
 
-wstring
-punctuations::do_filter(const wstring& s)
+void
+punctuations::apply(const wstring& src, wstring& dst,
+                    filter_context& context) const
 {
-  wstring result(s);
-  for (unsigned int i = verbosity; i < char_list.length(); i++)
-    replace_all(result, char_list.substr(i, 1), pronunciation[i]);
-  return result;
+  if (static_cast<unsigned int>(context.verbosity) >= char_list.length())
+    {
+      dst = src;
+      return;
+    }
+  dst.reserve(src.length());
+  for (wstring::const_iterator ch = src.begin(); ch != src.end(); ++ch)
+    {
+      unsigned int code = static_cast<unsigned int>(*ch);
+      if ((code < table_size) && (position[code] >= context.verbosity))
+        dst += pronunciation[position[code]];
+      else dst += *ch;
+    }
+}
+
+
+// filter_context members:
+
+filter_context::filter_context(punctuations::mode punctuations_mode):
+  verbosity(punctuations_mode)
+{
+  source.reserve(initial_capacity);
+  destination.reserve(initial_capacity);
 }
 
 
 // char_translations members:
 
-char_translations::char_translations(const map<wchar_t, const wchar_t*>& table):
-  translation_table(table)
+char_translations::char_translations(const item* table):
+  direct(direct_range),
+  longest(1)
 {
+  for (const item* entry = table; entry->translation; entry++)
+    {
+      replacement translation;
+      translation.text = entry->translation;
+      translation.length = wcslen(entry->translation);
+      if (static_cast<unsigned int>(entry->character) < direct_range)
+        {
+          if (direct[entry->character].text)
+            continue;
+          direct[entry->character] = translation;
+        }
+      else
+        {
+          vector<pair<wchar_t, replacement> >::iterator place =
+            lower_bound(fallback.begin(), fallback.end(), entry->character, precedes);
+          if ((place != fallback.end()) && (place->first == entry->character))
+            continue;
+          fallback.insert(place, make_pair(entry->character, translation));
+        }
+      if (translation.length > longest)
+        longest = translation.length;
+    }
 }
 
-wstring
-char_translations::do_filter(const wstring& s)
+void
+char_translations::apply(const wstring& src, wstring& dst,
+                         filter_context& context) const
 {
-  wstring result;
-  map<wchar_t, const wchar_t*>::const_iterator item;
-  BOOST_FOREACH(wchar_t ch, s)
+  dst.reserve(src.length() * longest);
+  for (wstring::const_iterator ch = src.begin(); ch != src.end(); ++ch)
     {
-      item = translation_table.find(ch);
-      if (item != translation_table.end())
-        result += item->second;
-      else result += ch;
+      const replacement* translation = NULL;
+      if (static_cast<unsigned int>(*ch) < direct_range)
+        {
+          if (direct[*ch].text)
+            translation = &direct[*ch];
+        }
+      else if (!fallback.empty())
+        {
+          vector<pair<wchar_t, replacement> >::const_iterator item =
+            lower_bound(fallback.begin(), fallback.end(), *ch, precedes);
+          if ((item != fallback.end()) && (item->first == *ch))
+            translation = &item->second;
+        }
+      if (translation)
+        dst.append(translation->text, translation->length);
+      else dst += *ch;
     }
-  return result;
+}
+
+bool
+char_translations::precedes(const pair<wchar_t, replacement>& item, wchar_t ch)
+{
+  return item.first < ch;
 }
 
 
@@ -141,10 +228,11 @@ simple_substitution::simple_substitution(const wchar_t* pattern, const wchar_t*
 {
 }
 
-wstring
-simple_substitution::do_filter(const wstring& s)
+void
+simple_substitution::apply(const wstring& src, wstring& dst,
+                           filter_context& context) const
 {
-  return regex_replace(s, re, fmt);
+  regex_replace(back_inserter(dst), src.begin(), src.end(), re, fmt);
 }
 
 
@@ -157,16 +245,203 @@ advanced_substitution::advanced_substitution(const wchar_t* pattern, const forma
 {
 }
 
-wstring
-advanced_substitution::do_filter(const wstring& s)
+void
+advanced_substitution::apply(const wstring& src, wstring& dst,
+                             filter_context& context) const
+{
+  // Every search starts from the end of previous match
+  // as if it were the beginning of the text.
+  wsmatch found;
+  wstring::const_iterator start = src.begin();
+  while (regex_search(start, src.end(), found, re))
+    {
+      dst.append(start, found[0].first);
+      dst += replacer(make_iterator_range(found[0].first, found[0].second));
+      start = found[0].second;
+      if (found[0].first == found[0].second)
+        {
+          if (start == src.end())
+            break;
+          dst += *start++;
+        }
+    }
+  dst.append(start, src.end());
+}
+
+
+// Substitution rules analysis helpers:
+
+// Check if the pattern refers to its own subexpressions:
+static bool
+back_references(const wchar_t* pattern)
+{
+  for (const wchar_t* c = pattern; *c; c++)
+    if (*c == L'\\')
+      {
+        if (!*++c)
+          break;
+        if (((*c >= L'1') && (*c <= L'9')) || (*c == L'g') || (*c == L'k'))
+          return true;
+      }
+  return false;
+}
+
+// Transform replacement format. Subexpression references are passed
+// to the specified function along with the output buffer, escaped
+// characters are taken literally when requested, and the rest
+// is copied as is:
+template <typename reference_handler>
+static wstring
+transform_format(const wchar_t* fmt, bool unescape, reference_handler handle)
+{
+  wstring result;
+  for (const wchar_t* c = fmt; *c; c++)
+    if ((*c == L'\\') && c[1])
+      {
+        if (!unescape)
+          result += *c;
+        result += *++c;
+      }
+    else if ((*c == L'$') && (c[1] == L'&'))
+      {
+        handle(result, 0);
+        c++;
+      }
+    else if ((*c == L'$') && iswdigit(c[1]))
+      {
+        unsigned int n = 0;
+        while (iswdigit(c[1]))
+          n = n * 10 + (*++c - L'0');
+        handle(result, n);
+      }
+    else if ((*c == L'$') && (c[1] == L'{') && iswdigit(c[2]))
+      {
+        unsigned int n = 0;
+        for (c += 2; iswdigit(*c); c++)
+          n = n * 10 + (*c - L'0');
+        if (*c != L'}')
+          c--;
+        handle(result, n);
+      }
+    else if ((*c == L'$') && (c[1] == L'$'))
+      {
+        if (!unescape)
+          result += *c;
+        result += *++c;
+      }
+    else result += *c;
+  return result;
+}
+
+// Subexpression reference handlers:
+
+class renumbered_reference
+{
+public:
+  explicit renumbered_reference(unsigned int offset):
+    base(offset)
+  {
+  }
+
+  void operator()(wstring& fmt, unsigned int n) const
+  {
+    fmt += L"${";
+    fmt += lexical_cast<wstring>(base + n);
+    fmt += L'}';
+  }
+
+private:
+  unsigned int base;
+};
+
+static void
+skip_reference(wstring& text, unsigned int n)
+{
+}
+
+
+// substitution_set members:
+
+bool substitution_set::merging = true;
+
+substitution_set&
+substitution_set::operator()(const wchar_t* pattern, const wchar_t* replacement,
+                             bool icase_mode)
+{
+  rule item;
+  item.pattern = pattern;
+  item.replacement = replacement;
+  item.icase = icase_mode;
+  rules.push_back(item);
+  return *this;
+}
+
+bool
+substitution_set::independent(unsigned int i, unsigned int first) const
 {
-  return find_format_all_copy(s, regex_finder(re), replacer);
+  if (back_references(rules[i].pattern))
+    return false;
+  wregex re(rules[i].pattern, rules[i].icase ? (regex::normal | regex::icase) : regex::normal);
+  for (unsigned int j = first; j < i; j++)
+    if (back_references(rules[j].pattern) ||
+        regex_search(transform_format(rules[j].replacement, true, skip_reference), re))
+      return false;
+  return true;
+}
+
+
+// fused_substitution members:
+
+fused_substitution::fused_substitution(const substitution_set& group,
+                                       unsigned int first, unsigned int last)
+{
+  wstring pattern;
+  unsigned int groups = 0;
+  for (unsigned int i = first; i < last; i++)
+    {
+      const substitution_set::rule& rule = group.rules[i];
+      alternative item;
+      item.group = ++groups;
+      item.replacement = transform_format(rule.replacement, false, renumbered_reference(item.group));
+      alternatives.push_back(item);
+      groups += wregex(rule.pattern).mark_count();
+      if (i > first)
+        pattern += L'|';
+      pattern += rule.icase ? L"((?i:" : L"((?:";
+      pattern += rule.pattern;
+      pattern += L"))";
+    }
+  re.assign(pattern, regex::normal);
+}
+
+void
+fused_substitution::apply(const wstring& src, wstring& dst,
+                          filter_context& context) const
+{
+  // Matches are searched as regex_replace() does, but the match
+  // results are kept in the context, so no memory is allocated:
+  match_results<wstring::const_iterator>& found = context.found;
+  match_flag_type flags = match_default;
+  wstring::const_iterator start = src.begin();
+  while (regex_search(start, src.end(), found, re, flags, src.begin()))
+    {
+      dst.append(start, found[0].first);
+      const alternative* rule = &alternatives.front();
+      while (!found[rule->group].matched)
+        rule++;
+      found.format(back_inserter(dst), rule->replacement);
+      start = found[0].second;
+      flags = match_prev_avail;
+      if (found[0].first == found[0].second)
+        flags |= regex_constants::match_not_initial_null;
+    }
+  dst.append(start, src.end());
 }
 
 
 // text_filter_constructor members:
 
-text_filter_constructor::text_filter_constructor(filtering_wostream* owner):
+text_filter_constructor::text_filter_constructor(text_filter* owner):
   filter(owner)
 {
 }
@@ -174,21 +449,21 @@ text_filter_constructor::text_filter_constructor(filtering_wostream* owner):
 text_filter_constructor&
 text_filter_constructor::operator()(case_conversion::mode case_mode)
 {
-  filter->push(case_conversion(case_mode));
+  filter->stages.push_back(boost::shared_ptr<filter_stage>(new case_conversion(case_mode)));
   return *this;
 }
 
 text_filter_constructor&
-text_filter_constructor::operator()(const vector<const wchar_t*>& pronunciations_list)
+text_filter_constructor::operator()(const wchar_t* const (&pronunciations_list)[punctuations::count])
 {
-  filter->push(punctuations(pronunciations_list));
+  filter->stages.push_back(boost::shared_ptr<filter_stage>(new punctuations(pronunciations_list)));
   return *this;
 }
 
 text_filter_constructor&
-text_filter_constructor::operator()(const map<wchar_t, const wchar_t*>& table)
+text_filter_constructor::operator()(const char_translations::item* table)
 {
-  filter->push(char_translations(table));
+  filter->stages.push_back(boost::shared_ptr<filter_stage>(new char_translations(table)));
   return *this;
 }
 
@@ -196,7 +471,7 @@ text_filter_constructor&
 text_filter_constructor::operator()(const wchar_t* pattern, const wchar_t* replacement,
                                     bool icase_mode)
 {
-  filter->push(simple_substitution(pattern, replacement, icase_mode));
+  filter->stages.push_back(boost::shared_ptr<filter_stage>(new simple_substitution(pattern, replacement, icase_mode)));
   return *this;
 }
 
@@ -205,7 +480,26 @@ text_filter_constructor::operator()(const wchar_t* pattern,
                                     const advanced_substitution::formatter& fmt,
                                     bool icase_mode)
 {
-  filter->push(advanced_substitution(pattern, fmt, icase_mode));
+  filter->stages.push_back(boost::shared_ptr<filter_stage>(new advanced_substitution(pattern, fmt, icase_mode)));
+  return *this;
+}
+
+text_filter_constructor&
+text_filter_constructor::operator()(const substitution_set& group)
+{
+  // Every run of independent rules makes one stage:
+  unsigned int first = 0;
+  while (first < group.rules.size())
+    {
+      unsigned int last = first + 1;
+      if (substitution_set::merging)
+        while ((last < group.rules.size()) && group.independent(last, first))
+          last++;
+      if (last - first > 1)
+        filter->stages.push_back(boost::shared_ptr<filter_stage>(new fused_substitution(group, first, last)));
+      else (*this)(group.rules[first].pattern, group.rules[first].replacement, group.rules[first].icase);
+      first = last;
+    }
   return *this;
 }
 
@@ -217,13 +511,27 @@ text_filter::text_filter(void)
 }
 
 wstring
-text_filter::process(const wstring& text)
+text_filter::process(const wstring& text, filter_context& context) const
 {
-  wostringstream result;
-  push(result);
-  (*this) << text;
-  pop();
-  return result.str();
+  if (stages.empty())
+    return text;
+  wstring result;
+  result.reserve(text.length() + (text.length() >> 1) + 1);
+  wstring::const_iterator start = text.begin();
+  while (start != text.end())
+    {
+      wstring::const_iterator end = find(start, text.end(), L'\n');
+      filter_line(start, end, 0, result, context);
+      start = (end == text.end()) ? end : end + 1;
+    }
+  return result;
+}
+
+wstring
+text_filter::process(const wstring& text) const
+{
+  filter_context context;
+  return process(text, context);
 }
 
 text_filter_constructor
@@ -231,3 +539,53 @@ text_filter::setup(void)
 {
   return text_filter_constructor(this);
 }
+
+bool
+text_filter::empty(void) const
+{
+  return stages.empty();
+}
+
+unsigned int
+text_filter::passes(void) const
+{
+  unsigned int count = 0;
+  for (vector<boost::shared_ptr<filter_stage> >::const_iterator stage = stages.begin(); stage != stages.end(); ++stage)
+    count += (*stage)->passes();
+  return count;
+}
+
+void
+text_filter::filter_line(wstring::const_iterator start,
+                         wstring::const_iterator end,
+                         unsigned int stage, wstring& output,
+                         filter_context& context) const
+{
+  wstring& source = context.source;
+  wstring& destination = context.destination;
+  source.assign(start, end);
+  while (stage < stages.size())
+    {
+      destination.clear();
+      stages[stage++]->apply(source, destination, context);
+      source.swap(destination);
+      if ((stage < stages.size()) &&
+          (source.find(L'\n') != wstring::npos))
+        {
+          // The rest of the chain sees each line separately.
+          const wstring lines(source);
+          wstring::const_iterator line = lines.begin();
+          while (true)
+            {
+              wstring::const_iterator eol = find(line, lines.end(), L'\n');
+              filter_line(line, eol, stage, output, context);
+              if (eol == lines.end())
+                break;
+              line = eol + 1;
+            }
+          return;
+        }
+    }
+  output += source;
+  output += L'\n';
+}
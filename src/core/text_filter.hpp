@@ -18,6 +18,18 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+// The text filter chain is an ordered set of transformation stages.
+// Text is processed line by line, as if it were passed through
+// a chain of line filters: each line is fed to the first stage
+// and the result is passed to the next one and so on, every line of
+// the result being terminated by the newline character. Every stage
+// transforms source buffer into the destination one, so only two
+// working buffers are reused through the whole chain. These buffers
+// along with the filtering conditions, such as punctuations verbosity,
+// belong to the filter context supplied by the caller. The chain
+// itself is not changed while processing, so it can be used by several
+// threads at once, each one having its own context.
+
 // Text filter chain construction is as simple as follows:
 //
 // text_filter filter;
@@ -42,32 +54,55 @@
 // (case_conversion::mode) specifies case conversion.
 // See case_conversion class definition for details.
 //
-// (const std::vector<const wchar_t*>&) specifies punctuations
-// verbosing filter.
+// (const wchar_t* const (&)[punctuations::count]) specifies
+// punctuations verbosing filter.
 // See punctuations class definitions for details.
 //
-// (const std::map<wchar_t, const wchar_t*>&) specifies general
+// (const char_translations::item*) specifies general
 // character translation filter.
 // See char_translation class definition for details.
+//
+// (const substitution_set&) specifies a group of independent
+// regular expression replacements merged into one pattern,
+// so they are performed in a single scan.
+// See substitution_set class definition for details.
 
 #ifndef MULTISPEECH_TEXT_FILTER_HPP
 #define MULTISPEECH_TEXT_FILTER_HPP
 
 #include <string>
 #include <vector>
-#include <map>
+#include <utility>
 
 #include <boost/range.hpp>
 #include <boost/regex.hpp>
 #include <boost/function.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/filter/line.hpp>
+#include <boost/shared_ptr.hpp>
 
 
 // Filter primitives for chain construction:
 
+class filter_context;
+
+// Abstract filter stage. Actual transformation should be implemented
+// in derived classes by the apply() method. It takes source line
+// and places the result into the destination buffer, which is
+// always empty on entry. Any intermediate state should be kept
+// in the context rather than in the stage itself.
+class filter_stage
+{
+public:
+  virtual ~filter_stage(void);
+
+  virtual void apply(const std::wstring& src, std::wstring& dst,
+                     filter_context& context) const = 0;
+
+  // Number of scans over the text made by the stage:
+  virtual unsigned int passes(void) const;
+};
+
 // Case conversion filter:
-class case_conversion: public boost::iostreams::wline_filter
+class case_conversion: public filter_stage
 {
 public:
   enum mode
@@ -78,14 +113,15 @@ public:
 
   explicit case_conversion(mode md);
 
-private:
-  std::wstring do_filter(const std::wstring& s);
+  void apply(const std::wstring& src, std::wstring& dst,
+             filter_context& context) const;
 
+private:
   mode conversion_mode;
 };
 
 // Verbose punctuations:
-class punctuations: public boost::iostreams::wline_filter
+class punctuations: public filter_stage
 {
 public:
   // Available punctuation verbosity modes:
@@ -96,7 +132,12 @@ public:
     none = 1000 // Beyond the list
   };
 
-  explicit punctuations(const std::vector<const wchar_t*>& pronunciations_list);
+  // Number of pronounceable punctuation characters:
+  static const unsigned int count = 32;
+
+  // Pronunciations are to be listed in the following order:
+  // !'?,.;:-@#$%^&*_()+=[]{}\|"/`~<>
+  explicit punctuations(const wchar_t* const (&pronunciations_list)[count]);
 
   // Get punctuations mode corresponding to identifying character:
   static mode from_char(char c);
@@ -105,48 +146,109 @@ public:
   // set current mode according to identifying character:
   static void set_mode(wchar_t wc);
 
+  // Default mode for the requests that do not specify it:
   static mode verbosity;
 
+  void apply(const std::wstring& src, std::wstring& dst,
+             filter_context& context) const;
+
 private:
-  std::wstring do_filter(const std::wstring& s);
+  // Pronunciations indexed by position in the char_list. Each one
+  // is already expanded as if the rest of the list were applied to it
+  // one by one, so a single pass over the text gives the same result.
+  std::vector<std::wstring> pronunciation;
+
+  // Position in the char_list indexed by character code
+  // or -1 for characters that are not listed:
+  static const unsigned int table_size = 128;
+  short int position[table_size];
 
-  const std::vector<const wchar_t*>& pronunciation;
   static const std::wstring char_list;
 };
 
+// Filtering conditions and working buffers for a particular request:
+class filter_context
+{
+public:
+  explicit filter_context(punctuations::mode punctuations_mode = punctuations::verbosity);
+
+  // Punctuations verbosity:
+  punctuations::mode verbosity;
+
+private:
+  // Working buffers reserved for typical utterance length:
+  static const std::size_t initial_capacity = 256;
+  std::wstring source, destination;
+
+  // Match results reused by substitution sets:
+  boost::match_results<std::wstring::const_iterator> found;
+
+  friend class text_filter;
+  friend class fused_substitution;
+};
+
 // Character translation filter:
-class char_translations: public boost::iostreams::wline_filter
+class char_translations: public filter_stage
 {
 public:
-  explicit char_translations(const std::map<wchar_t, const wchar_t*>& table);
+  // Translation table item:
+  class item
+  {
+  public:
+    wchar_t character;
+    const wchar_t* translation;
+  };
+
+  // The table is terminated by an item with null translation.
+  // When a character is listed more than once,
+  // the first translation is used.
+  explicit char_translations(const item* table);
+
+  void apply(const std::wstring& src, std::wstring& dst,
+             filter_context& context) const;
 
 private:
-  std::wstring do_filter(const std::wstring& s);
+  // Single character translation:
+  class replacement
+  {
+  public:
+    const wchar_t* text;
+    std::size_t length;
+  };
+
+  // Translations for characters from Basic Latin up to Cyrillic
+  // are indexed directly by character code. Entries with null text
+  // denote characters to be left as is.
+  static const unsigned int direct_range = 0x500;
+  std::vector<replacement> direct;
 
-  const std::map<wchar_t, const wchar_t*>& translation_table;
+  // Translations for the rest of characters sorted by code:
+  std::vector<std::pair<wchar_t, replacement> > fallback;
+
+  // Maximum replacement length for output size estimation:
+  std::size_t longest;
+
+  static bool precedes(const std::pair<wchar_t, replacement>& item, wchar_t ch);
 };
 
-// Define our own class for regular expression filter here
-// because the one provided by the Boost library is buggy.
-// Moreover, it seems more natural to derive it from the
-// line filter rather than from the aggregate one.
-// Anyway, it is quite simple.
-class simple_substitution: public boost::iostreams::wline_filter
+// Global regular expression replacement:
+class simple_substitution: public filter_stage
 {
 public:
   simple_substitution(const wchar_t* pattern, const wchar_t* replacement,
                       bool icase_mode = false);
 
-private:
-  std::wstring do_filter(const std::wstring& s);
+  void apply(const std::wstring& src, std::wstring& dst,
+             filter_context& context) const;
 
+private:
   const boost::wregex re;
   const wchar_t* fmt;
 };
 
 // More flexible variant of the regular expression filter.
 // It provides possibility to specify replacement as a formatter.
-class advanced_substitution: public boost::iostreams::wline_filter
+class advanced_substitution: public filter_stage
 {
 public:
   typedef boost::function<std::wstring(const boost::iterator_range<std::wstring::const_iterator>&)> formatter;
@@ -154,48 +256,146 @@ public:
   advanced_substitution(const wchar_t* pattern, const formatter& fmt,
                         bool icase_mode = false);
 
-private:
-  std::wstring do_filter(const std::wstring& s);
+  void apply(const std::wstring& src, std::wstring& dst,
+             filter_context& context) const;
 
+private:
   const boost::wregex re;
   const formatter replacer;
 };
 
+// Group of regular expression replacements to be fused into one stage.
+// The group is constructed similarly to the filter chain:
+//
+// substitution_set()
+//   (pattern_1, replacement_1[, icase_mode_1])
+//   ...
+//   (pattern_n, replacement_n[, icase_mode_n])
+//
+// The patterns are combined in one alternation, so the text
+// is scanned only once. At every step the leftmost match is replaced,
+// the first rule winning when several ones match at the same position.
+// It gives the same result as the sequence of separate replacements
+// only when the rules are independent, i.e. no rule can match text
+// produced or affected by another one. The group is split into
+// separate stages where a rule matches text inserted by a preceding
+// one or refers to its own subexpressions by back references.
+// Other dependencies cannot be detected here, so the groups
+// are checked against sequential replacement by the tests.
+class substitution_set
+{
+public:
+  substitution_set& operator()(const wchar_t* pattern, const wchar_t* replacement,
+                               bool icase_mode = false);
+
+  // When false, every rule makes a separate stage. It is used
+  // to get the reference result for checking:
+  static bool merging;
+
+private:
+  class rule
+  {
+  public:
+    const wchar_t* pattern;
+    const wchar_t* replacement;
+    bool icase;
+  };
+
+  std::vector<rule> rules;
+
+  // Check if the rule can be performed in one scan
+  // with the preceding ones starting from specified position:
+  bool independent(unsigned int i, unsigned int first) const;
+
+  friend class fused_substitution;
+  friend class text_filter_constructor;
+};
+
+// Filter stage performing a run of substitution set rules
+// by one combined pattern. Every rule pattern is enclosed
+// in its own group, which tells what rule has matched,
+// and subexpression references in the replacements
+// are renumbered accordingly.
+class fused_substitution: public filter_stage
+{
+public:
+  fused_substitution(const substitution_set& group,
+                     unsigned int first, unsigned int last);
+
+  void apply(const std::wstring& src, std::wstring& dst,
+             filter_context& context) const;
+
+private:
+  // Rule replacement and the number of the group enclosing its pattern:
+  class alternative
+  {
+  public:
+    std::wstring replacement;
+    unsigned int group;
+  };
+
+  std::vector<alternative> alternatives;
+  boost::wregex re;
+};
 
 // Filter chain construction tools:
 
+class text_filter;
+
 // This class is not for direct use. It's only purpose is to provide
 // simple and natural syntax for the filter chain construction.
 class text_filter_constructor
 {
 public:
-  explicit text_filter_constructor(boost::iostreams::filtering_wostream* owner);
+  explicit text_filter_constructor(text_filter* owner);
 
   text_filter_constructor& operator()(case_conversion::mode case_mode);
-  text_filter_constructor& operator()(const std::vector<const wchar_t*>& pronunciations_list);
-  text_filter_constructor& operator()(const std::map<wchar_t, const wchar_t*>& table);
+  text_filter_constructor& operator()(const wchar_t* const (&pronunciations_list)[punctuations::count]);
+  text_filter_constructor& operator()(const char_translations::item* table);
   text_filter_constructor& operator()(const wchar_t* pattern, const wchar_t* replacement,
                                       bool icase_mode = false);
   text_filter_constructor& operator()(const wchar_t* pattern,
                                       const advanced_substitution::formatter& fmt,
                                       bool icase_mode = false);
+  text_filter_constructor& operator()(const substitution_set& group);
 
 private:
-  boost::iostreams::filtering_wostream* filter;
+  text_filter* filter;
 };
 
 // Text filter chain.
-class text_filter: public boost::iostreams::filtering_wostream
+class text_filter
 {
 public:
   // Object constructor:
   text_filter(void);
 
-  // Perform filtering:
-  std::wstring process(const std::wstring& text);
+  // Perform filtering. When no context is specified,
+  // the default one is used:
+  std::wstring process(const std::wstring& text, filter_context& context) const;
+  std::wstring process(const std::wstring& text) const;
 
   // Filter chain assembling:
   text_filter_constructor setup(void);
+
+  // Return true when there are no stages in the chain:
+  bool empty(void) const;
+
+  // Number of scans over the text made by all the stages:
+  unsigned int passes(void) const;
+
+private:
+  // Filter chain stages:
+  std::vector<boost::shared_ptr<filter_stage> > stages;
+
+  // Pass one line through the chain starting from specified stage
+  // and append the result to the output:
+  void filter_line(std::wstring::const_iterator start,
+                   std::wstring::const_iterator end,
+                   unsigned int stage, std::wstring& output,
+                   filter_context& context) const;
+
+  friend class text_filter_constructor;
 };
 
 #endif
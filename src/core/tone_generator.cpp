@@ -129,7 +129,7 @@ tone_generator::source_release(void)
 void
 tone_generator::notify_completion(void)
 {
-  event.notify_one();
+  task_completed();
   host.notify_one();
 }
 
@@ -44,9 +44,9 @@ public:
 
 private:
   // Properties accessible only for actual executor:
-  const unsigned int frequency;
-  const float duration;
-  const float volume;
+  unsigned int frequency;
+  float duration;
+  float volume;
 
   friend class tone_generator;
 };
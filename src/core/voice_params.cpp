@@ -41,6 +41,17 @@ voice_params::voice_params(voice_params* other):
 {
 }
 
+voice_params::voice_params(double volume_level, double speech_rate,
+                           double voice_pitch, double sampling_deviation,
+                           punctuations::mode verbosity):
+  volume(volume_level),
+  rate(speech_rate),
+  pitch(voice_pitch),
+  deviation(sampling_deviation),
+  punctuations_mode(verbosity)
+{
+}
+
 
 // Protected methods:
 
@@ -37,6 +37,11 @@ public:
   // Copy constructor:
   voice_params(voice_params* other);
 
+  // Explicit parameters specification:
+  voice_params(double volume_level, double speech_rate,
+               double voice_pitch, double sampling_deviation,
+               punctuations::mode verbosity);
+
   // Parameter values:
   double volume, rate, pitch, deviation;
   punctuations::mode punctuations_mode;
@@ -20,112 +20,178 @@
 
 #include <string>
 
-#include <boost/regex.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include "dtk_voices.hpp"
 
 using namespace std;
-using namespace boost;
+using namespace boost::algorithm;
+
+
+// Only valid values replace previously found ones:
+static void
+update(double& target, double value)
+{
+  if (value >= 0.0)
+    target = value;
+}
 
 
 // Object construction:
 
 dtk_voices::dtk_voices(void):
-  inline_parser(L"^\\s*\\[\\s*:.*]", L"\\[\\s*:np\\s*]", L"\\[[^]]*]"),
-  person_extractor(L"^\\s*\\[\\s*:n([phfdbuwrkv]).*]"),
-  pitch_range_extractor(L"^\\s*\\[.*:dv\\s(.*\\s)?pr\\s+(\\d+(\\.\\d*)?).*]"),
-  average_pitch_extractor(L"^\\s*\\[.*:dv\\s(.*\\s)?ap\\s+(\\d+(\\.\\d*)?).*]"),
-  head_size_extractor(L"^\\s*\\[.*:dv\\s(.*\\s)?hs\\s+(\\d+(\\.\\d*)?).*]"),
-  rate_extractor(L"^\\s*\\[.*:ra(te)?\\s+(\\d+(\\.\\d*)?).*]"),
-  volume_extractor(L"^\\s*\\[.*:volu(me)?\\s+set\\s+(\\d+(\\.\\d*)?).*]"),
-  mode_extractor(L"^\\s*\\[.*:pu(nct?)?\\s+(\\S).*]"),
-  save_cmd_detector(L"^\\s*\\[.*:dv\\s(.*\\s)?save(\\s.*)?]"),
+  pitch_range(-1.0),
+  average_pitch(-1.0),
+  head_size(-1.0),
+  rate_value(-1.0),
+  volume_value(-1.0),
+  person(0),
+  mode_value(L' '),
+  voice_definition(false),
+  save_request(false),
   val_pitch(1.0),
   val_deviation(1.0)
 {
 }
 
 
-// Actual parameters extraction methods:
+// Actual parser methods:
+
+bool
+dtk_voices::detect(const code& item) const
+{
+  return !item.empty() && starts_with(item.front(), L":");
+}
 
 void
-dtk_voices::get_person(wstring& data)
+dtk_voices::reset(void)
 {
-  wsmatch parse_result;
-  if (regex_search(data, parse_result, person_extractor) &&
-      parse_result[1].matched)
-    switch (parse_result[1].first[0])
-      {
-      case L'p': // Paul
-        pitch = 1.0;
-        deviation = 1.0;
-        break;
-      case L'h': // Harry
-        pitch = 0.5;
-        deviation = 1.0;
-        break;
-      case L'd': // Dennis
-        pitch = 0.7;
-        deviation = 0.875;
-        break;
-      case L'f': // Frank
-        pitch = 0.7;
-        deviation = 0.75;
-        break;
-      case L'b': // Betty
-        pitch = 1.4;
-        deviation = 1.0625;
-        break;
-      case L'u': // Ursula
-        pitch = 1.3;
-        deviation = 1.0;
-        break;
-      case L'r': // Rita
-        pitch = 1.4;
-        deviation = 1.125;
-        break;
-      case L'w': // Wendy
-        pitch = 1.5;
-        deviation = 1.0625;
-        break;
-      case L'k': // Kit
-        pitch = 2.0;
-        deviation = 1.25;
-        break;
-      case L'v': // Val
-        pitch = val_pitch;
-        deviation = val_deviation;
-      default:
-        break;
-      }
+  pitch_range = -1.0;
+  average_pitch = -1.0;
+  head_size = -1.0;
+  rate_value = -1.0;
+  volume_value = -1.0;
+  person = 0;
+  mode_value = L' ';
+  voice_definition = false;
+  save_request = false;
 }
 
 void
-dtk_voices::extract_parameters(wstring& data)
+dtk_voices::interpret(const code& item, bool first)
+{
+  // Predefined voice may be chosen only by the very first command:
+  if (first && (item.front().size() > 2) && starts_with(item.front(), L":n"))
+    person = item.front()[2];
+  for (unsigned int i = 0; i < item.size(); i++)
+    {
+      const word& command = item[i];
+      const word* argument = ((i + 1) < item.size()) ? &item[i + 1] : 0;
+      if (ends_with(command, L":dv"))
+        voice_definition = true;
+      else if (ends_with(command, L":ra") || ends_with(command, L":rate"))
+        {
+          if (argument)
+            update(rate_value, get_value(argument->begin(), argument->end()));
+        }
+      else if (ends_with(command, L":volu") || ends_with(command, L":volume"))
+        {
+          if (argument && equals(*argument, L"set") && ((i + 2) < item.size()))
+            update(volume_value, get_value(item[i + 2].begin(), item[i + 2].end()));
+        }
+      else if (ends_with(command, L":pu") || ends_with(command, L":punc") ||
+               ends_with(command, L":punct"))
+        {
+          if (argument)
+            mode_value = argument->front();
+        }
+      else if (voice_definition && command.spaced)
+        {
+          // Voice definition parameters:
+          if (equals(command, L"save"))
+            save_request = true;
+          else if (!argument)
+            continue;
+          else if (equals(command, L"pr"))
+            update(pitch_range, get_value(argument->begin(), argument->end()));
+          else if (equals(command, L"ap"))
+            update(average_pitch, get_value(argument->begin(), argument->end()));
+          else if (equals(command, L"hs"))
+            update(head_size, get_value(argument->begin(), argument->end()));
+        }
+    }
+}
+
+void
+dtk_voices::extract_parameters(void)
 {
-  wsmatch parse_result;
-  double pitch_range = get_value(data, pitch_range_extractor),
-    average_pitch = get_value(data, average_pitch_extractor),
-    head_size = get_value(data, head_size_extractor);
   pitch = 1.0;
   deviation = 1.0;
-  volume = -1.0;
-  get_person(data);
+  get_person();
   if (pitch_range >= 0.0)
     deviation = (400.0 + pitch_range) / 500.0;
   if (average_pitch >= 0.0)
     pitch = average_pitch / 150.0;
   else if (head_size >= 0.0)
     pitch = 5.0 - (head_size * 3.0 / 80.0);
-  rate = get_value(data, rate_extractor) / rate_scale;
-  volume = get_value(data, volume_extractor) / volume_scale;
-  if (regex_search(data, save_cmd_detector, match_default | match_any))
+  rate = rate_value / rate_scale;
+  volume = volume_value / volume_scale;
+  if (save_request)
     {
       val_pitch = pitch;
       val_deviation = deviation;
     }
-  set_punctuations_mode((regex_search(data, parse_result, mode_extractor) &&
-                         parse_result[2].matched) ?
-                        parse_result[2].first[0] :
-                        L' ');
+  set_punctuations_mode(mode_value);
+}
+
+
+// Predefined voices:
+
+void
+dtk_voices::get_person(void)
+{
+  switch (person)
+    {
+    case L'p': // Paul
+      pitch = 1.0;
+      deviation = 1.0;
+      break;
+    case L'h': // Harry
+      pitch = 0.5;
+      deviation = 1.0;
+      break;
+    case L'd': // Dennis
+      pitch = 0.7;
+      deviation = 0.875;
+      break;
+    case L'f': // Frank
+      pitch = 0.7;
+      deviation = 0.75;
+      break;
+    case L'b': // Betty
+      pitch = 1.4;
+      deviation = 1.0625;
+      break;
+    case L'u': // Ursula
+      pitch = 1.3;
+      deviation = 1.0;
+      break;
+    case L'r': // Rita
+      pitch = 1.4;
+      deviation = 1.125;
+      break;
+    case L'w': // Wendy
+      pitch = 1.5;
+      deviation = 1.0625;
+      break;
+    case L'k': // Kit
+      pitch = 2.0;
+      deviation = 1.25;
+      break;
+    case L'v': // Val
+      pitch = val_pitch;
+      deviation = val_deviation;
+    default:
+      break;
+    }
 }
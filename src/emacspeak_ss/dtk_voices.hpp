@@ -34,7 +34,6 @@
 #include <string>
 
 #include <boost/config.hpp>
-#include <boost/regex.hpp>
 
 #include "inline_parser.hpp"
 
@@ -48,17 +47,24 @@ private:
   // Reference values:
   static BOOST_CONSTEXPR_OR_CONST double rate_scale = 200.0, volume_scale = 50.0;
 
-  // Patterns for parameters extraction:
-  const boost::wregex person_extractor, pitch_range_extractor,
-    average_pitch_extractor, head_size_extractor, rate_extractor,
-    volume_extractor, mode_extractor, save_cmd_detector;
+  // Collected parameter values:
+  double pitch_range, average_pitch, head_size, rate_value, volume_value;
+  wchar_t person, mode_value;
+
+  // Voice definition command state:
+  bool voice_definition, save_request;
 
   // Saved voice parameters:
   double val_pitch, val_deviation;
 
-  // Actual parameters extraction methods:
-  void get_person(std::wstring& data);
-  void extract_parameters(std::wstring& data);
+  // Actual parser methods (see base class):
+  bool detect(const code& item) const;
+  void reset(void);
+  void interpret(const code& item, bool first);
+  void extract_parameters(void);
+
+  // Choose predefined voice:
+  void get_person(void);
 };
 
 #endif
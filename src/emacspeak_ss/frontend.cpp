@@ -20,6 +20,8 @@
 
 #include <cstdlib>
 #include <string>
+#include <vector>
+#include <utility>
 #include <iostream>
 #include <sstream>
 
@@ -76,7 +78,8 @@ const frontend::Entry frontend::command_table[] =
 
 // Object construction:
 
-frontend::frontend(void):
+frontend::frontend(int input, int output, polyglot* linguist):
+  speech_server(input, output, linguist),
   CmdFinder<FunctionPtr>(command_table, command_table +
                          (sizeof(command_table) / sizeof(Entry)),
                          USE_FIRST),
@@ -85,7 +88,8 @@ frontend::frontend(void):
   beep_parameters(L"^(\\d+)?(\\s+(\\d+))?$"),
   lang_parameters(L"^(\\S+)(\\s+(\\S+))?$"),
   tts_parameters(L"^[a-z]+\\s+(\\d+)\\s+\\S+\\s+(\\d+)\\s+(\\d+)"),
-  garbage(L"\\s*\\[\\*]\\s*")
+  garbage(L"\\s*\\[\\*]\\s*"),
+  disbalance(0)
 {
   if (support_native_voices)
     native_params.reset(new multispeech_voices);
@@ -99,40 +103,52 @@ frontend::frontend(void):
 void
 frontend::get_command(void)
 {
-  string s;
-  getline(cin, s);
-  if (cin.eof() || cin.fail())
+  channel::line s;
+  if (!io.get_line(s))
     {
       speech_server::cmd = "exit";
       exit_status = EXIT_FAILURE;
     }
   else
     {
-      accumulator << s << endl;
-      data = intern_string(accumulator.str(), frontend_charset);
-      int disbalance = 0;
-      for (unsigned int i = 0; i < data.length(); i++)
-        switch (data[i])
+      // Only the new line is converted and scanned,
+      // so long multiline texts are accepted in linear time.
+      received.assign(s.begin(), s.end());
+      intern_string line(received, frontend_charset);
+      for (unsigned int i = 0; i < line.length(); i++)
+        switch (line[i])
           {
           case L'{':
             disbalance++;
-            data[i] = L' ';
+            line[i] = L' ';
             break;
           case L'}':
             disbalance--;
-          case L'\n':
-            data[i] = L' ';
+            line[i] = L' ';
           default:
             break;
           }
+      pending += line;
+      pending += L' ';
       if (!disbalance)
-        speech_server::cmd = extern_string(data);
+        speech_server::cmd = extern_string(pending);
       else if ((disbalance < 0) || (disbalance > 1))
         communication_reset();
     }
 }
 
 
+// Prepare to the next command reception cycle:
+
+void
+frontend::communication_reset(void)
+{
+  speech_server::communication_reset();
+  pending.erase();
+  disbalance = 0;
+}
+
+
 // Command set and syntax implementation:
 
 bool
@@ -178,16 +194,16 @@ frontend::do_enqueue_speech(void)
   voice_params* voice = extract_parameters();
   if (!voice)
     voice = queue_voice.get();
-  if (voice)
-    soundmaster.enqueue(speechmaster.text_task(data, voice));
-  else soundmaster.enqueue(speechmaster.text_task(data));
+  vector<speech_task> tasks(speechmaster.text_tasks(data, voice));
+  for (vector<speech_task>::iterator task = tasks.begin(); task != tasks.end(); ++task)
+    soundmaster.enqueue(std::move(*task));
   return true;
 }
 
 bool
 frontend::do_say_letter(void)
 {
-  soundmaster.execute(speechmaster.letter_task(regex_replace(data, garbage, L" ")));
+  soundmaster.execute_interactive(speechmaster.letter_task(regex_replace(data, garbage, L" ")));
   return true;
 }
 
@@ -227,9 +243,18 @@ frontend::do_say_message(void)
 {
   soundmaster.stop();
   voice_params* voice = extract_parameters();
-  if (voice)
-    soundmaster.execute(speechmaster.text_task(data, voice, true));
-  else soundmaster.execute(speechmaster.text_task(data, true));
+  vector<speech_task> tasks(speechmaster.text_tasks(data, voice, true));
+  if (tasks.size() == 1)
+    soundmaster.execute(tasks.front());
+  else if (!tasks.empty())
+    {
+      // A long message is split into parts. They are queued
+      // in place of the queue just cleared, so the first part
+      // starts playing while the rest are waiting.
+      for (vector<speech_task>::iterator task = tasks.begin(); task != tasks.end(); ++task)
+        soundmaster.enqueue(std::move(*task));
+      soundmaster.proceed();
+    }
   return true;
 }
 
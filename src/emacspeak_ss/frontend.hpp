@@ -35,14 +35,19 @@ class frontend:
   private FBB::CmdFinder<bool (frontend::*)(void)>
 {
 public:
-  // Construct the object:
-  frontend(void);
+  // Construct the object. Daemon sessions talk via the client
+  // socket and use shared speech engines:
+  explicit frontend(int input = STDIN_FILENO, int output = STDOUT_FILENO,
+                    polyglot* linguist = NULL);
 
 private:
   // Input method and command syntax definition (see base class):
   void get_command(void);
   bool perform_command(void);
 
+  // Clear partially received command (see base class):
+  void communication_reset(void);
+
   // Additional parsers for inline parameters extraction:
   boost::scoped_ptr<inline_parser> native_params, dtk_params;
 
@@ -86,6 +91,16 @@ private:
   // Additional data provided with some commands:
   std::wstring data;
 
+  // Multiline command is accumulated here line by line
+  // with curly braces and line breaks already blanked out:
+  std::wstring pending;
+
+  // Curly braces balance in the pending text:
+  int disbalance;
+
+  // Reusable storage for the line being converted:
+  std::string received;
+
   // Working area for regex match result representation:
   boost::wsmatch parse_result;
 
@@ -18,25 +18,23 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+#include <cwctype>
 #include <string>
+#include <algorithm>
 
-#include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include "inline_parser.hpp"
 
 using namespace std;
 using namespace boost;
+using namespace boost::algorithm;
 
 
 // Object construction / destruction:
 
-inline_parser::inline_parser(const wstring& detector,
-                             const wstring& precleaner,
-                             const wstring& postcleaner):
-  params_detector(detector),
-  trash(precleaner),
-  garbage(postcleaner)
+inline_parser::inline_parser(void)
 {
 }
 
@@ -44,33 +42,122 @@ inline_parser::~inline_parser(void)
 {
 }
 
+inline_parser::word::word(wstring::const_iterator first,
+                          wstring::const_iterator last,
+                          bool after_space):
+  iterator_range<wstring::const_iterator>(first, last),
+  spaced(after_space)
+{
+}
+
 
 // Public methods:
 
 bool
 inline_parser::parse(wstring& data)
 {
-  bool result = false;
-  if (regex_search(data, params_detector, match_default | match_any))
-    {
-      data = regex_replace(data, trash, L"");
-      extract_parameters(data);
-      data = regex_replace(data, garbage, L"");
-      result = true;
-    }
-  return result;
+  const wstring& source = data;
+
+  // The text must begin with a recognized code:
+  wstring::const_iterator c = source.begin();
+  while ((c != source.end()) && iswspace(*c))
+    ++c;
+  if ((c == source.end()) || (*c != L'['))
+    return false;
+  wstring::const_iterator close = find(c + 1, source.end(), L']');
+  if (close == source.end())
+    return false;
+  split(c + 1, close);
+  if (!detect(words))
+    return false;
+
+  // Scan the text once stripping out all the codes:
+  bool leading = true, first = true, applicable = false;
+  reset();
+  text.clear();
+  c = source.begin();
+  while (c != source.end())
+    if (*c == L'[')
+      {
+        close = find(c + 1, source.end(), L']');
+        if (close == source.end())
+          {
+            text.append(c, source.end());
+            break;
+          }
+        split(c + 1, close);
+        c = close + 1;
+        if (!trash())
+          {
+            if (first)
+              applicable = leading && anchored(words);
+            if (applicable)
+              interpret(words, first);
+            first = false;
+          }
+      }
+    else
+      {
+        if (!iswspace(*c))
+          leading = false;
+        text += *c++;
+      }
+  extract_parameters();
+  data.swap(text);
+  return true;
 }
 
 
 // Protected methods:
 
 double
-inline_parser::get_value(std::wstring& data, const boost::wregex& extractor)
+inline_parser::get_value(wstring::const_iterator first,
+                         wstring::const_iterator last,
+                         bool integer)
+{
+  wstring::const_iterator c = first;
+  while ((c != last) && (*c >= L'0') && (*c <= L'9'))
+    ++c;
+  if (c == first)
+    return -1.0;
+  if (!integer && (c != last) && (*c == L'.'))
+    do ++c;
+    while ((c != last) && (*c >= L'0') && (*c <= L'9'));
+  return lexical_cast<double>(wstring(first, c));
+}
+
+
+// Private methods:
+
+void
+inline_parser::split(wstring::const_iterator first,
+                     wstring::const_iterator last)
+{
+  words.clear();
+  bool spaced = false;
+  while (first != last)
+    if (iswspace(*first))
+      {
+        spaced = true;
+        ++first;
+      }
+    else
+      {
+        wstring::const_iterator start = first;
+        while ((first != last) && !iswspace(*first))
+          ++first;
+        words.push_back(word(start, first, spaced));
+      }
+}
+
+bool
+inline_parser::anchored(const code& item) const
+{
+  return true;
+}
+
+bool
+inline_parser::trash(void) const
 {
-  wsmatch parse_result;
-  double result_value = -1.0;
-  if (regex_search(data, parse_result, extractor) &&
-      parse_result[2].matched)
-    result_value = lexical_cast<double>(wstring(parse_result[2].first, parse_result[2].second));
-  return result_value;
+  return (words.size() == 1) && equals(words.front(), L":np");
 }
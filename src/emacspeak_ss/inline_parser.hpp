@@ -18,12 +18,20 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
+// The inline_parser class scans the text once, recognizes embedded
+// voice control codes enclosed in square brackets, passes them
+// to the actual parser split into words and strips them out
+// of the text at the same time. The parameters are taken into account
+// only when the text begins with a recognized code. Later occurrences
+// of a parameter take precedence.
+
 #ifndef MULTISPEECH_INLINE_PARSER_HPP
 #define MULTISPEECH_INLINE_PARSER_HPP
 
 #include <string>
+#include <vector>
 
-#include <boost/regex.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include "voice_params.hpp"
 
@@ -32,9 +40,7 @@ class inline_parser: public voice_params
 {
 protected:
   // Object constructor:
-  inline_parser(const std::wstring& detector,
-                const std::wstring& precleaner,
-                const std::wstring& postcleaner);
+  inline_parser(void);
 
 public:
   // Destructor is made public to accommodate smart pointers:
@@ -45,16 +51,56 @@ public:
   bool parse(std::wstring& data);
 
 protected:
+  // Inline codes are split into words separated by whitespace:
+  class word: public boost::iterator_range<std::wstring::const_iterator>
+  {
+  public:
+    word(std::wstring::const_iterator first,
+         std::wstring::const_iterator last,
+         bool after_space);
+
+    bool spaced; // preceded by whitespace inside the code
+  };
+  typedef std::vector<word> code;
+
   // Value extraction helper to ease actual parser design
-  // in derived classes:
-  double get_value(std::wstring& data, const boost::wregex& extractor);
+  // in derived classes. The word must begin with a number,
+  // otherwise negative value is returned.
+  static double get_value(std::wstring::const_iterator first,
+                          std::wstring::const_iterator last,
+                          bool integer = false);
 
 private:
-  // Patterns for parsing:
-  const boost::wregex params_detector, trash, garbage;
+  // Words of the code being processed:
+  code words;
+
+  // Text with inline codes stripped out:
+  std::wstring text;
+
+  // Split inline code into words:
+  void split(std::wstring::const_iterator first,
+             std::wstring::const_iterator last);
+
+  // Check if the code is a mere prosody suppression mark
+  // that should be ignored:
+  bool trash(void) const;
+
+  // Actual parser must be implemented in derived classes.
+  // Check if the code introduces embedded parameters:
+  virtual bool detect(const code& item) const = 0;
+
+  // Check if the code at the text beginning allows parameters
+  // to be collected. Any code is accepted by default:
+  virtual bool anchored(const code& item) const;
+
+  // Forget parameters collected before:
+  virtual void reset(void) = 0;
+
+  // Collect parameters from the code:
+  virtual void interpret(const code& item, bool first) = 0;
 
-  // Actual parameters extractor must be implemented in derived classes:
-  virtual void extract_parameters(std::wstring& data) = 0;
+  // Set up voice parameters from collected values:
+  virtual void extract_parameters(void) = 0;
 };
 
 #endif
@@ -33,6 +33,11 @@ private:
     return new frontend;
   }
 
+  speech_server* attach(int client, polyglot& linguist)
+  {
+    return new frontend(client, client, &linguist);
+  }
+
   bool is_spd(void)
   {
     return false;
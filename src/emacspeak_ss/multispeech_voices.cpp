@@ -20,39 +20,93 @@
 
 #include <string>
 
-#include <boost/regex.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 #include "multispeech_voices.hpp"
 
 using namespace std;
-using namespace boost;
+using namespace boost::algorithm;
+
+
+// Only valid values replace previously found ones:
+static void
+update(double& target, double value)
+{
+  if (value >= 0.0)
+    target = value;
+}
 
 
 // Object construction:
 
 multispeech_voices::multispeech_voices(void):
-  inline_parser(L"^\\s*\\[_:.*]", L"\\[\\s*:np\\s*]", L"\\[[^]]*]"),
-  freq_extractor(L"^\\s*\\[_:(.*\\s)?fr:(\\d+).*]"),
-  pitch_extractor(L"^\\s*\\[_:(.*\\s)?pi:(\\d+(\\.\\d*)?).*]"),
-  rate_extractor(L"^\\s*\\[_:(.*\\s)?ra:(\\d+(\\.\\d*)?).*]"),
-  volume_extractor(L"^\\s*\\[_:(.*\\s)?vo:(\\d+(\\.\\d*)?).*]"),
-  mode_extractor(L"^\\s*\\[_:(.*\\s)?pu:(.+)]")
+  freq_value(-1.0),
+  pitch_value(-1.0),
+  rate_value(-1.0),
+  volume_value(-1.0),
+  mode_value(L' ')
+{
+}
+
+
+// Actual parser methods:
+
+bool
+multispeech_voices::detect(const code& item) const
 {
+  return !item.empty() && !item.front().spaced &&
+    starts_with(item.front(), L"_:");
 }
 
+bool
+multispeech_voices::anchored(const code& item) const
+{
+  return detect(item);
+}
 
-// Actual parameters extractor:
+void
+multispeech_voices::reset(void)
+{
+  freq_value = -1.0;
+  pitch_value = -1.0;
+  rate_value = -1.0;
+  volume_value = -1.0;
+  mode_value = L' ';
+}
+
+void
+multispeech_voices::interpret(const code& item, bool first)
+{
+  for (unsigned int i = 0; i < item.size(); i++)
+    {
+      // Parameters are separated by whitespace. The first one
+      // may also immediately follow the code prefix.
+      wstring::const_iterator name = item[i].begin();
+      if (first && !i)
+        name += 2;
+      else if (!item[i].spaced)
+        continue;
+      word parameter(name, item[i].end(), true);
+      wstring::const_iterator value = name + 3;
+      if (starts_with(parameter, L"pu:"))
+        mode_value = (value != parameter.end()) ? *value : L' ';
+      else if (starts_with(parameter, L"fr:"))
+        update(freq_value, get_value(value, parameter.end(), true));
+      else if (starts_with(parameter, L"pi:"))
+        update(pitch_value, get_value(value, parameter.end()));
+      else if (starts_with(parameter, L"ra:"))
+        update(rate_value, get_value(value, parameter.end()));
+      else if (starts_with(parameter, L"vo:"))
+        update(volume_value, get_value(value, parameter.end()));
+    }
+}
 
 void
-multispeech_voices::extract_parameters(wstring& data)
+multispeech_voices::extract_parameters(void)
 {
-  wsmatch parse_result;
-  volume = get_value(data, volume_extractor);
-  rate = get_value(data, rate_extractor) / rate_scale;
-  pitch = get_value(data, pitch_extractor);
-  deviation = get_value(data, freq_extractor) / ref_freq;
-  set_punctuations_mode((regex_search(data, parse_result, mode_extractor) &&
-                         parse_result[2].matched) ?
-                        parse_result[2].first[0] :
-                        L' ');
+  volume = volume_value;
+  rate = rate_value / rate_scale;
+  pitch = pitch_value;
+  deviation = freq_value / ref_freq;
+  set_punctuations_mode(mode_value);
 }
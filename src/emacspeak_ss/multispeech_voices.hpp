@@ -27,7 +27,6 @@
 #include <string>
 
 #include <boost/config.hpp>
-#include <boost/regex.hpp>
 
 #include "inline_parser.hpp"
 
@@ -41,12 +40,16 @@ private:
   // Reference values:
   static BOOST_CONSTEXPR_OR_CONST double ref_freq = 16000.0, rate_scale = 200.0;
 
-  // Patterns for parameters extraction:
-  const boost::wregex freq_extractor, pitch_extractor, rate_extractor, volume_extractor,
-    mode_extractor;
+  // Collected parameter values:
+  double freq_value, pitch_value, rate_value, volume_value;
+  wchar_t mode_value;
 
-  // Actual parameters extraction method:
-  void extract_parameters(std::wstring& data);
+  // Actual parser methods (see base class):
+  bool detect(const code& item) const;
+  bool anchored(const code& item) const;
+  void reset(void);
+  void interpret(const code& item, bool first);
+  void extract_parameters(void);
 };
 
 #endif
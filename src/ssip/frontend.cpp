@@ -20,15 +20,18 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cwctype>
 #include <string>
 #include <sstream>
-#include <iostream>
 #include <vector>
+#include <utility>
+#include <algorithm>
 #include <stdexcept>
 
 #include <bobcat/string>
 
 #include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/regex.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -37,6 +40,7 @@
 #include "config.hpp"
 #include "strcvt.hpp"
 #include "file_player.hpp"
+#include "sound_cache.hpp"
 
 #include "sysconfig.hpp"
 #if HAVE_LIBSPEECHD_VERSION_H
@@ -58,6 +62,7 @@ const string frontend::bad_syntax("302 ERROR BAD SYNTAX");
 // Speech Dispatcher module commands:
 const frontend::Entry frontend::command_table[] =
   {
+    Entry("INIT", &frontend::do_init),
     Entry("SPEAK", &frontend::do_speak),
     Entry("SOUND_ICON", &frontend::do_sound_icon),
     Entry("CHAR", &frontend::do_char),
@@ -74,44 +79,60 @@ const frontend::Entry frontend::command_table[] =
   };
 static const string cmd_init("INIT");
 
+// Internal index mark terminating a streamed message.
+// Real mark names never contain line breaks:
+static const string end_of_message("\n");
+
+// Streamed message lines are not read while the speech queue
+// holds more items than this, so memory consumption is bounded
+// however long the message is:
+static const unsigned int stream_backlog = 8;
+
 
 // Object instantiation:
 
 frontend*
 frontend::instantiate(void)
 {
-  string cmd;
-  getline(cin, cmd);
-  if (cin.eof() || cin.fail())
-    throw logic_error("Broken pipe when reading INIT");
-  if (cmd_init != cmd)
-    throw logic_error("Wrong communication from module client: didn't call INIT");
+  // Client input is buffered by the instance, so it is
+  // constructed before the INIT command can be read.
   frontend* instance = new frontend;
-  cout << "299-" << package::name << ": Initialized successfully." << endl;
-  cout << "299 OK LOADED SUCCESSFULLY" << endl;
+  channel::line cmd;
+  if (!instance->io.get_line(cmd))
+    {
+      delete instance;
+      throw logic_error("Broken pipe when reading INIT");
+    }
+  if (cmd_init != string(cmd.begin(), cmd.end()))
+    {
+      delete instance;
+      throw logic_error("Wrong communication from module client: didn't call INIT");
+    }
+  instance->do_init();
+  instance->io.flush();
   return instance;
 }
 
+frontend*
+frontend::attach(int client, polyglot& linguist)
+{
+  return new frontend(client, client, &linguist);
+}
+
 
 // Object construction:
 
-frontend::frontend(void):
+frontend::frontend(int input, int output, polyglot* linguist):
+  speech_server(input, output, linguist),
   CmdFinder<FunctionPtr>(command_table, command_table +
                          (sizeof(command_table) / sizeof(Entry)),
                          USE_FIRST),
   settings(speechmaster),
   lines(0),
-  mark_pattern("<mark\\s+name=\"([^\"]*)\"\\s*/>"),
-  state(idle)
+  complete(false),
+  state(idle),
+  drained(false)
 {
-  stripper.setup()
-    (L"<[^<>]+>", L"")
-    (L"&lt;", L"<")
-    (L"&gt;", L">")
-    (L"&amp;", L"&")
-    (L"&quot;", L"\"")
-    (L"&apos;", L"'");
-
   int version_major = LIBSPEECHD_MAJOR_VERSION;
   int version_minor = LIBSPEECHD_MINOR_VERSION;
   regex version_format("(\\d+)(\\.(\\d+))?.*");
@@ -143,6 +164,14 @@ frontend::frontend(void):
         }
     }
   atom_separator = ((version_major < 1) && (version_minor < 9)) ? ' ' : '\t';
+
+  // Sound icons are shared by daemon sessions:
+  static bool preloaded = false;
+  if (!preloaded)
+    {
+      sound_cache::preload(spd_sound_icons);
+      preloaded = true;
+    }
 }
 
 
@@ -154,6 +183,7 @@ frontend::communication_reset(void)
   speech_server::communication_reset();
   data.erase();
   lines = 0;
+  complete = false;
 }
 
 
@@ -165,8 +195,8 @@ frontend::extra_data(const char* msg)
   if (state_ok())
     {
       if (!lines)
-        cout << (msg ? msg : "202 OK RECEIVING MESSAGE") << endl;
-      return (lines < 0) || !data.empty();
+        io.put_line(msg ? msg : "202 OK RECEIVING MESSAGE");
+      return complete;
     }
   return false;
 }
@@ -179,8 +209,8 @@ frontend::can_speak(void)
 {
   bool ok = (state == idle) && !data.empty();
   if (ok)
-    cout << "200 OK SPEAKING" << endl;
-  else cout << "301 ERROR CANT SPEAK" << endl;
+    io.put_line("200 OK SPEAKING");
+  else io.put_line("301 ERROR CANT SPEAK");
   return ok;
 }
 
@@ -189,7 +219,7 @@ frontend::single_line(void)
 {
   if (lines < 2)
     return true;
-  cout << "305 DATA MORE THAN ONE LINE" << endl;
+  io.put_line("305 DATA MORE THAN ONE LINE");
   return false;
 }
 
@@ -201,7 +231,69 @@ frontend::start_queue(void)
 {
   state = speaking;
   soundmaster.proceed();
-  cout << "701 BEGIN" << endl;
+  io.put_line("701 BEGIN");
+}
+
+
+// Streaming reception:
+
+void
+frontend::receive_text(void)
+{
+  {
+    boost::mutex::scoped_lock lock(access);
+    // Short messages are received completely and spoken as usual,
+    // so streaming starts only when the text got so far is long enough:
+    if (!complete && spd_stream_threshold &&
+        (data.length() > spd_stream_threshold) &&
+        (state == idle))
+      {
+        state = receiving;
+        drained = false;
+        ssml.start();
+      }
+    if (state != receiving)
+      return;
+  }
+
+  // The queue is running, so its events may come at any moment.
+  // Hence the lock is not held while enqueueing.
+  string part;
+  part.swap(data);
+  enqueue_items(ssml.feed(intern_string(part, frontend_charset), spd_stream_threshold));
+  soundmaster.proceed();
+  wait_queue(stream_backlog);
+}
+
+bool
+frontend::finish_streaming(void)
+{
+  {
+    boost::mutex::scoped_lock lock(access);
+    if (state != receiving)
+      return false;
+  }
+  enqueue_items(ssml.finish());
+  soundmaster.enqueue(string(end_of_message));
+  {
+    boost::mutex::scoped_lock lock(access);
+    io.put_line("200 OK SPEAKING");
+    io.put_line("701 BEGIN");
+    for (vector<string>::const_iterator name = deferred.begin(); name != deferred.end(); ++name)
+      {
+        io.put_line("700-" + *name);
+        io.put_line("700 INDEX MARK");
+      }
+    deferred.clear();
+    if (drained)
+      {
+        io.put_line("702 END");
+        state = idle;
+      }
+    else state = speaking;
+  }
+  soundmaster.proceed();
+  return true;
 }
 
 
@@ -211,10 +303,22 @@ void
 frontend::index_mark(const string& name)
 {
   boost::mutex::scoped_lock lock(access);
+  if (name == end_of_message)
+    {
+      if (state == receiving)
+        drained = true;
+      return;
+    }
+  if (state == receiving)
+    {
+      deferred.push_back(name);
+      return;
+    }
   if (state == pausing)
     soundmaster.stop();
-  cout << "700-" << name << endl;
-  cout << "700 INDEX MARK" << endl;
+  io.put_line("700-" + name);
+  io.put_line("700 INDEX MARK");
+  io.flush();
 }
 
 void
@@ -224,18 +328,22 @@ frontend::queue_done(void)
   switch (state)
     {
     case speaking:
-      cout << "702 END" << endl;
+      io.put_line("702 END");
       break;
     case stopping:
-      cout << "703 STOP" << endl;
+      io.put_line("703 STOP");
       break;
     case pausing:
-      cout << "704 PAUSE" << endl;
+      io.put_line("704 PAUSE");
       break;
+    case receiving:
+      // The message is not over yet:
+      return;
     default:
       break;
     }
   state = idle;
+  io.flush();
 }
 
 
@@ -244,33 +352,28 @@ frontend::queue_done(void)
 void
 frontend::get_command(void)
 {
-  string s;
-  getline(cin, s);
-  if (cin.eof() || cin.fail())
+  channel::line s;
+  if (!io.get_line(s))
     {
       if (speech_server::cmd.empty())
         speech_server::cmd = "QUIT";
       exit_status = EXIT_FAILURE;
     }
   else if (speech_server::cmd.empty())
-    speech_server::cmd = s;
-  else if (s == ".")
+    speech_server::cmd.assign(s.begin(), s.end());
+  else if (equals(s, "."))
     {
-      if (lines)
-        {
-          accumulator << flush;
-          data = accumulator.str();
-          accumulator.str("");
-        }
-      else lines = -1;
+      complete = true;
+      if (!lines)
+        lines = -1;
     }
   else
     {
       if (lines++)
-        accumulator << endl;
-      if (s == "..")
-        accumulator << ".";
-      else accumulator << s;
+        data += '\n';
+      if (equals(s, ".."))
+        data += '.';
+      else data.append(s.begin(), s.end());
     }
 }
 
@@ -278,12 +381,45 @@ frontend::get_command(void)
 // Place text chunk into the speech queue:
 
 void
-frontend::enqueue_text_chunk(string::const_iterator start, string::const_iterator end)
+frontend::enqueue_text_chunk(const ssml_parser::item& chunk, const string& language)
 {
-  if (start != end)
-    soundmaster.enqueue(speechmaster.text_task(stripper.process(intern_string(string(start, end), frontend_charset)), &settings));
+  bool switched = spd_accept_explicit_language &&
+    !chunk.language.empty() && (chunk.language != language);
+  if (switched)
+    speechmaster.language(chunk.language);
+  voice_params voice(&settings);
+  if (voice.volume > 0.0)
+    voice.volume = min(voice.volume * chunk.volume, 1.0);
+  if (voice.rate > 0.0)
+    voice.rate *= chunk.rate;
+  if (voice.pitch > 0.0)
+    voice.pitch *= chunk.pitch;
+  if (chunk.spelling)
+    {
+      for (wstring::const_iterator c = chunk.content.begin(); c != chunk.content.end(); ++c)
+        if (!iswspace(*c))
+          soundmaster.enqueue(speechmaster.letter_task(wstring(1, *c), &voice));
+    }
+  else
+    {
+      vector<speech_task> tasks(speechmaster.text_tasks(chunk.content, &voice));
+      for (vector<speech_task>::iterator task = tasks.begin(); task != tasks.end(); ++task)
+        soundmaster.enqueue(std::move(*task));
+    }
+  if (switched)
+    speechmaster.language(language);
 }
 
+void
+frontend::enqueue_items(const vector<ssml_parser::item>& items)
+{
+  string language(speechmaster.language());
+  for (vector<ssml_parser::item>::const_iterator item = items.begin(); item != items.end(); ++item)
+    if (item->type == ssml_parser::item::text)
+      enqueue_text_chunk(*item, language);
+    else if (spd_support_index_marks)
+      soundmaster.enqueue(extern_string(item->content, frontend_charset));
+}
 
 // Command set and syntax implementation:
 
@@ -304,7 +440,7 @@ frontend::state_ok(void)
 {
   if (exit_status != EXIT_SUCCESS)
     {
-      cout << "401 ERROR INTERNAL" <<endl;
+      io.put_line("401 ERROR INTERNAL");
       communication_reset();
       exit_status = EXIT_SUCCESS;
       return false;
@@ -312,36 +448,41 @@ frontend::state_ok(void)
   return true;
 }
 
+bool
+frontend::do_init(void)
+{
+  if (state_ok())
+    {
+      io.put_line(string("299-") + package::name + ": Initialized successfully.");
+      io.put_line("299 OK LOADED SUCCESSFULLY");
+      communication_reset();
+    }
+  return true;
+}
+
 bool
 frontend::do_quit(void)
 {
   if (exit_status == EXIT_SUCCESS)
-    cout << "210 OK QUIT" << endl;
+    io.put_line("210 OK QUIT");
   return false;
 }
 
 bool
 frontend::do_speak(void)
 {
+  if (lines > 0)
+    receive_text();
   if (extra_data())
     {
-      boost::mutex::scoped_lock lock(access);
-      if (can_speak())
+      if (!finish_streaming())
         {
-          string::const_iterator start = data.begin();
-          string::const_iterator end = data.end();
-          if (spd_support_index_marks)
+          boost::mutex::scoped_lock lock(access);
+          if (can_speak())
             {
-              smatch found;
-              while (regex_search(start, end, found, mark_pattern))
-                {
-                  enqueue_text_chunk(start, found[0].first);
-                  soundmaster.enqueue(string(found[1].first, found[1].second));
-                  start = found[0].second;
-                }
+              enqueue_items(ssml.parse(intern_string(data, frontend_charset)));
+              start_queue();
             }
-          enqueue_text_chunk(start, end);
-          start_queue();
         }
       communication_reset();
     }
@@ -358,7 +499,8 @@ frontend::do_char(void)
           boost::mutex::scoped_lock lock(access);
           if (can_speak())
             {
-              soundmaster.enqueue(speechmaster.letter_task(intern_string(data, frontend_charset), &settings));
+              soundmaster.enqueue(speechmaster.letter_task(intern_string(data, frontend_charset), &settings),
+                                  sound_manager::message);
               start_queue();
             }
         }
@@ -434,15 +576,22 @@ frontend::do_list_voices(void)
     return do_unknown();
   if (state_ok())
     {
-      for (int i = 0; i < speechmaster.talker.size(); i++)
-        if (speechmaster.talker[i].get())
-          {
-            cout << "200-" << speechmaster.talker[i]->name;
-            if (!speechmaster.talker[i]->voice.empty())
-              cout << '-' << speechmaster.talker[i]->voice;
-            cout << atom_separator << speechmaster.talker[i]->language->id << atom_separator << "none" << endl;
-          }
-      cout << "200 OK VOICE LIST SENT" << endl;
+      for (unsigned int i = 0; i < speechmaster.languages(); i++)
+        {
+          speech_engine* talker = speechmaster.backend(i);
+          if (talker)
+            {
+              string entry("200-" + talker->name);
+              if (!talker->voice.empty())
+                entry += '-' + talker->voice;
+              entry += atom_separator;
+              entry += talker->language->id;
+              entry += atom_separator;
+              entry += "none";
+              io.put_line(entry);
+            }
+        }
+      io.put_line("200 OK VOICE LIST SENT");
       communication_reset();
     }
   return true;
@@ -453,7 +602,7 @@ frontend::do_set(void)
 {
   if (extra_data("203 OK RECEIVING SETTINGS"))
     {
-      settings.apply(data);
+      io.put_line(settings.apply(data));
       communication_reset();
     }
   return true;
@@ -464,7 +613,7 @@ frontend::do_audio(void)
 {
   if (extra_data("207 OK RECEIVING AUDIO SETTINGS"))
     {
-      cout << "203 OK AUDIO INITIALIZED" << endl;
+      io.put_line("203 OK AUDIO INITIALIZED");
       communication_reset();
     }
   return true;
@@ -475,7 +624,7 @@ frontend::do_loglevel(void)
 {
   if (extra_data("207 OK RECEIVING LOGLEVEL SETTINGS"))
     {
-      cout << "203 OK LOG LEVEL SET" << endl;
+      io.put_line("203 OK LOG LEVEL SET");
       communication_reset();
     }
   return true;
@@ -493,7 +642,7 @@ frontend::do_debug(void)
               redirect_stderr();
               verbose = false;
             }
-          cout << "200 OK DEBUGGING OFF" << endl;
+          io.put_line("200 OK DEBUGGING OFF");
         }
       else
         {
@@ -503,11 +652,11 @@ frontend::do_debug(void)
               if (redirect_stderr(args[1].c_str()))
                 {
                   verbose = true;
-                  cout << "200 OK DEBUGGING ON" << endl;
+                  io.put_line("200 OK DEBUGGING ON");
                 }
-              else cout << "303 CANT OPEN CUSTOM DEBUG FILE" << endl;
+              else io.put_line("303 CANT OPEN CUSTOM DEBUG FILE");
             }
-          else cout << bad_syntax << endl;
+          else io.put_line(bad_syntax);
         }
       communication_reset();
     }
@@ -519,7 +668,7 @@ frontend::do_unknown(void)
 {
   if (state_ok())
     {
-      cout << "300 ERR UNKNOWN COMMAND" << endl;
+      io.put_line("300 ERR UNKNOWN COMMAND");
       communication_reset();
     }
   return true;
@@ -22,15 +22,15 @@
 #define MULTISPEECH_SSIP_FRONTEND_HPP
 
 #include <string>
+#include <vector>
 
 #include <boost/thread/mutex.hpp>
-#include <boost/regex.hpp>
 
 #include <bobcat/cmdfinder>
 
 #include "speech_server.hpp"
-#include "text_filter.hpp"
 #include "spd_settings.hpp"
+#include "ssml_parser.hpp"
 
 class frontend:
   public speech_server,
@@ -40,6 +40,10 @@ public:
   // Object instantiation:
   static frontend* instantiate(void);
 
+  // Daemon session instantiation. The session is initialized
+  // by the INIT command received as usual:
+  static frontend* attach(int client, polyglot& linguist);
+
   // Common message:
   static const std::string bad_syntax;
 
@@ -48,13 +52,15 @@ private:
   enum status
   {
     idle,
+    receiving,
     speaking,
     pausing,
     stopping
   };
 
   // Construct the object:
-  frontend(void);
+  frontend(int input = STDIN_FILENO, int output = STDOUT_FILENO,
+           polyglot* linguist = NULL);
 
   // Clear temporary data in order to start command reception cycle:
   void communication_reset(void);
@@ -69,6 +75,13 @@ private:
   // Queue execution start:
   void start_queue(void);
 
+  // Streaming reception of long messages. When the text received
+  // exceeds the stream threshold, it is parsed and queued as lines
+  // arrive, and speaking starts before the message end.
+  // Events are held back until the message is accepted:
+  void receive_text(void);
+  bool finish_streaming(void);
+
   // Serving events:
   void index_mark(const std::string& name);
   void queue_done(void);
@@ -81,10 +94,15 @@ private:
   // Check for internal error:
   bool state_ok(void);
 
-  // Place text chunk into the speech queue stripping SSML tags by the way:
-  void enqueue_text_chunk(std::string::const_iterator start, std::string::const_iterator end);
+  // Place parsed text chunk into the speech queue. The language
+  // is switched temporarily when the chunk requires it.
+  void enqueue_text_chunk(const ssml_parser::item& chunk, const std::string& language);
+
+  // Place parsed message items into the speech queue:
+  void enqueue_items(const std::vector<ssml_parser::item>& items);
 
   // Command executors:
+  bool do_init(void);
   bool do_speak(void);
   bool do_sound_icon(void);
   bool do_char(void);
@@ -108,19 +126,24 @@ private:
   // Additional data lines number;
   int lines;
 
+  // Set when additional data is received completely:
+  bool complete;
+
   // API version dependent atom separator for voice list:
   char atom_separator;
 
-  // SSML mark pattern:
-  const boost::regex mark_pattern;
-
-  // SSML tags stripper:
-  text_filter stripper;
+  // SSML messages parser:
+  ssml_parser ssml;
 
   // Synchronization means:
   boost::mutex access;
   status state;
 
+  // Index marks reached while receiving a streamed message
+  // and whether the message end was reached as well:
+  std::vector<std::string> deferred;
+  bool drained;
+
   // Recognized commands table:
   static const Entry command_table[];
 };
@@ -33,6 +33,11 @@ private:
     return frontend::instantiate();
   }
 
+  speech_server* attach(int client, polyglot& linguist)
+  {
+    return frontend::attach(client, linguist);
+  }
+
   bool is_spd(void)
   {
     return true;
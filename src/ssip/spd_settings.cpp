@@ -18,7 +18,6 @@
    Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
 */
 
-#include <iostream>
 #include <sstream>
 
 #include <boost/regex.hpp>
@@ -68,7 +67,7 @@ spd_settings::spd_settings(polyglot& linguist):
 
 // Public methods:
 
-void
+string
 spd_settings::apply(const string& message)
 {
   preserve state(this);
@@ -83,18 +82,16 @@ spd_settings::apply(const string& message)
       FunctionPtr action = get_function(option);
       if (beyond().empty())
         {
-          cout << frontend::bad_syntax << endl;
           state.restore();
-          return;
+          return frontend::bad_syntax;
         }
       else if ((this->*action)())
         {
-          cout << "303 ERROR INVALID PARAMETER OR VALUE" << endl;
           state.restore();
-          return;
+          return "303 ERROR INVALID PARAMETER OR VALUE";
         }
     }
-  cout << "203 OK SETTINGS RECEIVED" << endl;
+  return "203 OK SETTINGS RECEIVED";
 }
 
 
@@ -210,21 +207,24 @@ spd_settings::apply_synthesis_voice(void)
   if (beyond() != "NULL")
     {
       ostringstream voice(ios::app);
-      int i;
-      for (i = 0; i < speechmaster.talker.size(); i++)
-        if (speechmaster.talker[i].get())
-          {
-            voice.str(speechmaster.talker[i]->name);
-            if (!speechmaster.talker[i]->voice.empty())
-              voice << '-' << speechmaster.talker[i]->voice << flush;
-            if (beyond() == voice.str())
-              {
-                speechmaster.language(speechmaster.talker[i]->language->id);
-                accept_language = accept_language && !speech_server::spd_use_voice_language;
-                break;
-              }
-          }
-      if ((!speech_server::spd_ignore_unknown_voice) && (i >= speechmaster.talker.size()))
+      unsigned int i;
+      for (i = 0; i < speechmaster.languages(); i++)
+        {
+          speech_engine* talker = speechmaster.backend(i);
+          if (talker)
+            {
+              voice.str(talker->name);
+              if (!talker->voice.empty())
+                voice << '-' << talker->voice << flush;
+              if (beyond() == voice.str())
+                {
+                  speechmaster.language(talker->language->id);
+                  accept_language = accept_language && !speech_server::spd_use_voice_language;
+                  break;
+                }
+            }
+        }
+      if ((!speech_server::spd_ignore_unknown_voice) && (i >= speechmaster.languages()))
         {
           speechmaster.language(lang_id::autodetect);
           accept_language = accept_language && !speech_server::spd_use_voice_language;
@@ -40,7 +40,8 @@ public:
   // Object construction:
   explicit spd_settings(polyglot& linguist);
 
-  void apply(const std::string& message);
+  // Apply settings message. Returns the reply to be sent:
+  std::string apply(const std::string& message);
 
 private:
   // State saver:
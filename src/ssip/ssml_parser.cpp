@@ -0,0 +1,471 @@
+// ssml_parser.cpp -- SSML messages parser implementation
+/*
+   Copyright (C) 2019 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
+*/
+
+#include <cmath>
+#include <cwchar>
+#include <cwctype>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "ssml_parser.hpp"
+
+using namespace std;
+
+
+// Characters interrupting plain text:
+static const wchar_t special_chars[] = L"<&";
+
+// Tag delimiters. Tags are not expected to span lines:
+static const wchar_t tag_delimiters[] = L"<>\n";
+
+// Punctuation preferred for releasing text in incremental parsing:
+static const wchar_t sentence_ends[] = L".!?\u2026";
+static const wchar_t closing_marks[] = L"\"')]}\u00bb\u201d\u2019";
+
+// Predefined named prosody values:
+static const struct
+{
+  const wchar_t* name;
+  double value;
+} rate_values[] = {
+  { L"x-slow", 0.5 },
+  { L"slow", 0.75 },
+  { L"medium", 1.0 },
+  { L"fast", 1.5 },
+  { L"x-fast", 2.0 },
+  { L"default", 1.0 },
+  { NULL, 0.0 }
+}, pitch_values[] = {
+  { L"x-low", 0.6 },
+  { L"low", 0.8 },
+  { L"medium", 1.0 },
+  { L"high", 1.25 },
+  { L"x-high", 1.5 },
+  { L"default", 1.0 },
+  { NULL, 0.0 }
+}, volume_values[] = {
+  { L"silent", 0.0 },
+  { L"x-soft", 0.25 },
+  { L"soft", 0.5 },
+  { L"medium", 1.0 },
+  { L"loud", 1.5 },
+  { L"x-loud", 2.0 },
+  { L"default", 1.0 },
+  { NULL, 0.0 }
+};
+
+// Say-as interpretations requiring text to be spelled:
+static const wchar_t* const spelling_interpretations[] = {
+  L"characters",
+  L"spell-out",
+  L"letters",
+  L"tts:char",
+  NULL
+};
+
+// Prosody value interpretation. Plain numbers are scaled
+// by specified factor or ignored if it is zero:
+template <typename table>
+static double
+prosody_factor(const wstring& value, const table& names, double scale,
+               const wchar_t* unit, double (*convert)(double))
+{
+  for (unsigned int i = 0; names[i].name; i++)
+    if (value == names[i].name)
+      return names[i].value;
+  const wchar_t* text = value.c_str();
+  wchar_t* suffix;
+  double number = wcstod(text, &suffix);
+  if (suffix == text)
+    return 1.0;
+  bool relative = (*text == L'+') || (*text == L'-');
+  double result = 1.0;
+  if (!wcscmp(suffix, L"%"))
+    result = relative ? (1.0 + (number / 100.0)) : (number / 100.0);
+  else if (unit && !wcscmp(suffix, unit))
+    result = convert(number);
+  else if (!*suffix && !relative && scale)
+    result = number * scale;
+  return (result >= 0.0) ? result : 0.0;
+}
+
+static double
+semitones(double value)
+{
+  return pow(2.0, value / 12.0);
+}
+
+static double
+decibels(double value)
+{
+  return pow(10.0, value / 20.0);
+}
+
+// Check if the character belongs to the set:
+static bool
+member(wchar_t c, const wchar_t* set)
+{
+  return c && wcschr(set, c);
+}
+
+// Convert language tag to the language id:
+static string
+language_id(const wstring& tag)
+{
+  string id;
+  for (wstring::const_iterator c = tag.begin();
+       (c != tag.end()) && (*c < 0x80) && iswalpha(*c);
+       ++c)
+    id += static_cast<char>(towlower(*c));
+  return id;
+}
+
+
+// Object construction:
+
+ssml_parser::ssml_parser(void)
+{
+}
+
+
+// Public methods:
+
+const vector<ssml_parser::item>&
+ssml_parser::parse(const wstring& message)
+{
+  start();
+  process(message);
+  flush();
+  return items;
+}
+
+void
+ssml_parser::start(void)
+{
+  items.clear();
+  scopes.assign(1, scope());
+  scopes.back().volume = 1.0;
+  scopes.back().rate = 1.0;
+  scopes.back().pitch = 1.0;
+  scopes.back().spelling = false;
+  pending.clear();
+}
+
+const vector<ssml_parser::item>&
+ssml_parser::feed(const wstring& part, size_t threshold)
+{
+  items.clear();
+  process(part);
+  if (pending.length() >= threshold)
+    release();
+  return items;
+}
+
+const vector<ssml_parser::item>&
+ssml_parser::finish(void)
+{
+  items.clear();
+  flush();
+  return items;
+}
+
+
+// Private methods:
+
+void
+ssml_parser::process(const wstring& message)
+{
+  wstring::const_iterator position = message.begin();
+  while (position != message.end())
+    {
+      wstring::const_iterator stop = find_first_of(position, message.end(),
+                                                   special_chars, special_chars + 2);
+      pending.append(position, stop);
+      position = stop;
+      if (position == message.end())
+        break;
+      if (*position == L'&')
+        {
+          if (!decode_reference(position, message.end(), pending))
+            pending += *position++;
+        }
+      else
+        {
+          // Tag cannot start with a space or contain angle brackets
+          // or line breaks. Otherwise the opening bracket is taken literally.
+          wstring::const_iterator close = find_first_of(position + 1, message.end(),
+                                                        tag_delimiters, tag_delimiters + 3);
+          if ((close != message.end()) && (*close == L'>') && ((close - position) > 1) &&
+              !iswspace(position[1]))
+            {
+              bool empty = false;
+              if (split_tag(position + 1, close, empty))
+                start_element(empty);
+              else end_element();
+              position = close + 1;
+            }
+          else pending += *position++;
+        }
+    }
+}
+
+bool
+ssml_parser::scope::differs(const scope& other) const
+{
+  return (volume != other.volume) || (rate != other.rate) ||
+    (pitch != other.pitch) || (language != other.language) ||
+    (spelling != other.spelling);
+}
+
+void
+ssml_parser::start_element(bool empty)
+{
+  if (element.empty())
+    return;
+  scope next = scopes.back();
+  next.element = element;
+  const wstring* value = find_attribute(L"xml:lang");
+  if (value)
+    next.language = language_id(*value);
+  if (element == L"mark")
+    {
+      value = find_attribute(L"name");
+      if (value)
+        {
+          flush();
+          items.push_back(item());
+          items.back().type = item::mark;
+          items.back().content = *value;
+        }
+    }
+  else if (element == L"prosody")
+    {
+      if ((value = find_attribute(L"volume")))
+        next.volume *= volume_factor(*value);
+      if ((value = find_attribute(L"rate")))
+        next.rate *= rate_factor(*value);
+      if ((value = find_attribute(L"pitch")))
+        next.pitch *= pitch_factor(*value);
+    }
+  else if (element == L"say-as")
+    {
+      value = find_attribute(L"interpret-as");
+      next.spelling = false;
+      for (unsigned int i = 0; value && spelling_interpretations[i]; i++)
+        if (*value == spelling_interpretations[i])
+          next.spelling = true;
+    }
+  else if ((element == L"voice") || (element == L"lang"))
+    {
+      if ((value = find_attribute(L"language")))
+        next.language = language_id(*value);
+    }
+  if (!empty)
+    {
+      if (next.differs(scopes.back()))
+        flush();
+      scopes.push_back(next);
+    }
+}
+
+void
+ssml_parser::end_element(void)
+{
+  // Unmatched end tags are ignored. Elements
+  // left unclosed inside are closed as well.
+  for (size_t i = scopes.size() - 1; i > 0; i--)
+    if (scopes[i].element == element)
+      {
+        if (scopes.back().differs(scopes[i - 1]))
+          flush();
+        scopes.resize(i);
+        break;
+      }
+}
+
+void
+ssml_parser::flush(void)
+{
+  if (pending.empty())
+    return;
+  const scope& current = scopes.back();
+  items.push_back(item());
+  item& chunk = items.back();
+  chunk.type = item::text;
+  chunk.content.swap(pending);
+  chunk.volume = current.volume;
+  chunk.rate = current.rate;
+  chunk.pitch = current.pitch;
+  chunk.language = current.language;
+  chunk.spelling = current.spelling;
+  pending.clear();
+}
+
+void
+ssml_parser::release(void)
+{
+  size_t space = 0;
+  for (size_t i = pending.length(); i > 1; i--)
+    if (iswspace(pending[i - 1]))
+      {
+        size_t end = i - 1;
+        while ((end > 0) && member(pending[end - 1], closing_marks))
+          end--;
+        if ((end > 0) && member(pending[end - 1], sentence_ends))
+          {
+            space = i;
+            break;
+          }
+        if (!space)
+          space = i;
+      }
+  if (!space || (space == pending.length()))
+    flush();
+  else
+    {
+      wstring rest(pending, space);
+      pending.erase(space);
+      flush();
+      pending.swap(rest);
+    }
+}
+
+bool
+ssml_parser::split_tag(wstring::const_iterator first,
+                       wstring::const_iterator last,
+                       bool& empty)
+{
+  element.clear();
+  attributes.clear();
+  bool closing = *first == L'/';
+  if (closing)
+    ++first;
+  else if ((*first == L'!') || (*first == L'?'))
+    return true; // Comments and declarations are ignored
+  if ((first != last) && (*(last - 1) == L'/'))
+    {
+      empty = true;
+      --last;
+    }
+  while ((first != last) && !iswspace(*first))
+    element += *first++;
+  if (closing)
+    return false;
+  while (first != last)
+    {
+      while ((first != last) && iswspace(*first))
+        ++first;
+      if (first == last)
+        break;
+      attributes.push_back(attribute());
+      attribute& item = attributes.back();
+      while ((first != last) && (*first != L'=') && !iswspace(*first))
+        item.name += *first++;
+      while ((first != last) && iswspace(*first))
+        ++first;
+      if ((first == last) || (*first != L'='))
+        continue;
+      ++first;
+      while ((first != last) && iswspace(*first))
+        ++first;
+      if ((first != last) && ((*first == L'"') || (*first == L'\'')))
+        {
+          wchar_t quote = *first++;
+          while ((first != last) && (*first != quote))
+            item.value += *first++;
+          if (first != last)
+            ++first;
+        }
+      else while ((first != last) && !iswspace(*first))
+             item.value += *first++;
+    }
+  return true;
+}
+
+const wstring*
+ssml_parser::find_attribute(const wchar_t* name) const
+{
+  for (vector<attribute>::const_iterator item = attributes.begin(); item != attributes.end(); ++item)
+    if (item->name == name)
+      return &item->value;
+  return NULL;
+}
+
+bool
+ssml_parser::decode_reference(wstring::const_iterator& position,
+                              wstring::const_iterator end,
+                              wstring& destination)
+{
+  static const size_t max_length = 10;
+  wstring::const_iterator start = position + 1;
+  wstring::const_iterator stop = start;
+  while ((stop != end) && (*stop != L';') &&
+         (static_cast<size_t>(stop - start) < max_length))
+    ++stop;
+  if ((stop == end) || (*stop != L';') || (stop == start))
+    return false;
+  wstring name(start, stop);
+  wchar_t c = 0;
+  if (name == L"lt")
+    c = L'<';
+  else if (name == L"gt")
+    c = L'>';
+  else if (name == L"amp")
+    c = L'&';
+  else if (name == L"quot")
+    c = L'"';
+  else if (name == L"apos")
+    c = L'\'';
+  else if ((name[0] == L'#') && (name.length() > 1))
+    {
+      bool hex = (name[1] == L'x') || (name[1] == L'X');
+      const wchar_t* digits = name.c_str() + (hex ? 2 : 1);
+      wchar_t* tail;
+      unsigned long code = wcstoul(digits, &tail, hex ? 16 : 10);
+      if (*digits && !*tail && iswxdigit(*digits) && (code > 0) && (code <= 0x10FFFF))
+        c = static_cast<wchar_t>(code);
+    }
+  if (!c)
+    return false;
+  destination += c;
+  position = stop + 1;
+  return true;
+}
+
+double
+ssml_parser::rate_factor(const wstring& value)
+{
+  double result = prosody_factor(value, rate_values, 1.0, NULL, NULL);
+  return (result > 0.0) ? result : 1.0;
+}
+
+double
+ssml_parser::pitch_factor(const wstring& value)
+{
+  double result = prosody_factor(value, pitch_values, 0.0, L"st", semitones);
+  return (result > 0.0) ? result : 1.0;
+}
+
+double
+ssml_parser::volume_factor(const wstring& value)
+{
+  return prosody_factor(value, volume_values, 0.01, L"dB", decibels);
+}
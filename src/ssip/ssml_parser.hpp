@@ -0,0 +1,147 @@
+// ssml_parser.hpp -- SSML messages parser
+/*
+   Copyright (C) 2019 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.  
+*/
+
+// The ssml_parser class splits SSML message into a sequence of items
+// in a single pass: text segments along with relative voice parameters
+// they should be spoken with and index marks. Tags are stripped out
+// and character references are decoded on the fly. Prosody, say-as
+// and language changes take effect in the element scope. Unknown
+// elements are just stripped. Malformed markup is kept as plain text.
+// Long messages may be parsed incrementally as they are received.
+
+#ifndef MULTISPEECH_SSML_PARSER_HPP
+#define MULTISPEECH_SSML_PARSER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+class ssml_parser
+{
+public:
+  // Parsed message item:
+  class item
+  {
+  public:
+    enum kind
+    {
+      text,
+      mark
+    };
+
+    kind type;
+    std::wstring content; // text to speak or mark name
+
+    // Speech parameters relative to the current settings:
+    double volume, rate, pitch;
+
+    // Language to speak the text in, empty for the current one:
+    std::string language;
+
+    // The text should be spelled:
+    bool spelling;
+  };
+
+  // Object construction:
+  ssml_parser(void);
+
+  // Parse the message. Returned items are valid until next call.
+  const std::vector<item>& parse(const std::wstring& message);
+
+  // Incremental parsing. The message is passed by parts between
+  // start() and finish() calls. Each call returns the items completed
+  // by the time. Accumulated text is released at a sentence end
+  // or word boundary when it reaches the threshold length,
+  // so the text held back never grows much beyond it.
+  void start(void);
+  const std::vector<item>& feed(const std::wstring& part, std::size_t threshold);
+  const std::vector<item>& finish(void);
+
+private:
+  // Element scope state:
+  class scope
+  {
+  public:
+    std::wstring element;
+    double volume, rate, pitch;
+    std::string language;
+    bool spelling;
+
+    // Check if the text should be spoken differently:
+    bool differs(const scope& other) const;
+  };
+
+  // Tag attribute:
+  class attribute
+  {
+  public:
+    std::wstring name, value;
+  };
+
+  // Parsing results:
+  std::vector<item> items;
+
+  // Nested elements:
+  std::vector<scope> scopes;
+
+  // Working storage for tag parsing:
+  std::wstring element;
+  std::vector<attribute> attributes;
+
+  // Text accumulated in the current scope:
+  std::wstring pending;
+
+  // Parse the next part of the message appending items:
+  void process(const std::wstring& part);
+
+  // Process markup:
+  void start_element(bool empty);
+  void end_element(void);
+
+  // Put accumulated text in the items list:
+  void flush(void);
+
+  // Put accumulated text up to the last sentence end
+  // or word boundary in the items list:
+  void release(void);
+
+  // Split tag content into element name and attributes.
+  // Returns false if the tag is an end tag:
+  bool split_tag(std::wstring::const_iterator first,
+                 std::wstring::const_iterator last,
+                 bool& empty);
+
+  // Look for attribute value, returns NULL if not found:
+  const std::wstring* find_attribute(const wchar_t* name) const;
+
+  // Decode character reference starting at the ampersand.
+  // Returns false if it is not recognized.
+  static bool decode_reference(std::wstring::const_iterator& position,
+                               std::wstring::const_iterator end,
+                               std::wstring& destination);
+
+  // Interpret prosody attribute values:
+  static double rate_factor(const std::wstring& value);
+  static double pitch_factor(const std::wstring& value);
+  static double volume_factor(const std::wstring& value);
+};
+
+#endif
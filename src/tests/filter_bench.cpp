@@ -0,0 +1,155 @@
+// filter_bench.cpp -- Text filtering benchmark
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Usage: filter_bench [punctuations mode [language id]]
+//
+// Every language filter is applied to the sample texts longer
+// than 40 characters. For each language the number of passes
+// made over the text, CPU time and number of heap allocations
+// per utterance are reported. The timing is taken as the best
+// of several trials by the thread CPU clock, so other processes
+// running on the same machine affect it as little as possible.
+
+#include <time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/locale/generator.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "English.hpp"
+#include "Russian.hpp"
+#include "German.hpp"
+#include "French.hpp"
+#include "Spanish.hpp"
+#include "Italian.hpp"
+#include "Portuguese.hpp"
+#include "text_filter.hpp"
+#include "strcvt.hpp"
+
+using namespace std;
+
+
+// Heap allocations counter:
+static unsigned long allocations = 0;
+
+void*
+operator new(size_t size)
+{
+  void* block = malloc(size ? size : 1);
+  if (!block)
+    throw bad_alloc();
+  allocations++;
+  return block;
+}
+
+// It is kept out of line, so the compiler does not take the free()
+// call for a mismatched deallocation:
+void __attribute__((noinline))
+operator delete(void* block) throw()
+{
+  free(block);
+}
+
+// Thread CPU time in microseconds:
+static double
+cpu_time(void)
+{
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+int
+main(int argc, char* argv[])
+{
+  const unsigned int warmup_rounds = 10;
+  const unsigned int trials = 5;
+  const unsigned int rounds = 5;
+  const char* srcdir = getenv("srcdir");
+  string corpus_path(srcdir ? srcdir : ".");
+  corpus_path += "/corpus.txt";
+  ifstream corpus(corpus_path.c_str());
+  if (!corpus)
+    {
+      cerr << "Cannot read " << corpus_path << endl;
+      return EXIT_FAILURE;
+    }
+
+  locale::global(boost::locale::generator().generate("en_US.UTF-8"));
+
+  // Sample utterances. Line breaks inside them are marked by "\n":
+  vector<wstring> samples;
+  string line;
+  while (getline(corpus, line))
+    {
+      for (string::size_type pos = line.find("\\n"); pos != string::npos; pos = line.find("\\n", pos))
+        line.replace(pos, 2, "\n");
+      intern_string sample(line, "UTF-8");
+      if (sample.length() > 40)
+        samples.push_back(sample);
+    }
+
+  vector< boost::shared_ptr<language_description> > languages;
+  languages.push_back(boost::shared_ptr<language_description>(new English));
+  languages.push_back(boost::shared_ptr<language_description>(new Russian));
+  languages.push_back(boost::shared_ptr<language_description>(new German));
+  languages.push_back(boost::shared_ptr<language_description>(new French));
+  languages.push_back(boost::shared_ptr<language_description>(new Spanish));
+  languages.push_back(boost::shared_ptr<language_description>(new Italian));
+  languages.push_back(boost::shared_ptr<language_description>(new Portuguese));
+  for (unsigned int i = 0; i < languages.size(); i++)
+    languages[i]->prepare();
+
+  filter_context context((argc > 1) ? punctuations::from_char(argv[1][0]) : punctuations::some);
+  for (unsigned int i = 0; i < languages.size(); i++)
+    if ((argc < 3) || (string(argv[2]) == languages[i]->id))
+      {
+        language_description& lang = *languages[i];
+        for (unsigned int round = 0; round < warmup_rounds; round++)
+          for (unsigned int sample = 0; sample < samples.size(); sample++)
+            lang.filter(samples[sample], context);
+        double best = 0.0;
+        unsigned long allocated = 0;
+        for (unsigned int trial = 0; trial < trials; trial++)
+          {
+            unsigned long start_allocations = allocations;
+            double start = cpu_time();
+            for (unsigned int round = 0; round < rounds; round++)
+              for (unsigned int sample = 0; sample < samples.size(); sample++)
+                lang.filter(samples[sample], context);
+            double elapsed = cpu_time() - start;
+            if (!trial || (elapsed < best))
+              best = elapsed;
+            allocated = allocations - start_allocations;
+          }
+        double utterances = rounds * samples.size();
+        printf("%s: %u passes, %.1f us/utterance, %.1f allocs/utterance\n",
+               lang.id, lang.filter_passes(), best / utterances, allocated / utterances);
+      }
+
+  return EXIT_SUCCESS;
+}
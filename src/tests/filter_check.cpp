@@ -0,0 +1,199 @@
+// filter_check.cpp -- Substitution sets merging check
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Substitution set rules are merged into single pass stages
+// on the assumption that they do not depend on each other.
+// Some made up sets are checked first to make sure that dependent
+// rules are kept apart and subexpression references are renumbered.
+// Then every language filter is built twice, with the rules merged
+// and with every rule making a separate stage, and their outputs
+// are compared. The sample texts are taken from the corpus
+// and generated at random. Every punctuations mode is checked.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/locale/generator.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "English.hpp"
+#include "Russian.hpp"
+#include "German.hpp"
+#include "French.hpp"
+#include "Spanish.hpp"
+#include "Italian.hpp"
+#include "Portuguese.hpp"
+#include "text_filter.hpp"
+#include "strcvt.hpp"
+
+using namespace std;
+
+
+// Check a made up substitution set. Returns false on failure:
+static bool
+check_set(const char* title, const substitution_set& group,
+          unsigned int passes, const wchar_t* text, const wchar_t* expected)
+{
+  text_filter filter;
+  filter.setup()(group);
+  wstring result(filter.process(text));
+  if ((filter.passes() == passes) && (result == expected))
+    return true;
+  cerr << title << ": " << filter.passes() << " passes instead of " << passes
+       << ", \"" << extern_string(result, "UTF-8") << "\" instead of \""
+       << extern_string(expected, "UTF-8") << '"' << endl;
+  return false;
+}
+
+// Make up filters for all languages:
+static void
+make_languages(vector< boost::shared_ptr<language_description> >& languages)
+{
+  languages.push_back(boost::shared_ptr<language_description>(new English));
+  languages.push_back(boost::shared_ptr<language_description>(new Russian));
+  languages.push_back(boost::shared_ptr<language_description>(new German));
+  languages.push_back(boost::shared_ptr<language_description>(new French));
+  languages.push_back(boost::shared_ptr<language_description>(new Spanish));
+  languages.push_back(boost::shared_ptr<language_description>(new Italian));
+  languages.push_back(boost::shared_ptr<language_description>(new Portuguese));
+  for (unsigned int i = 0; i < languages.size(); i++)
+    languages[i]->prepare();
+}
+
+// Pseudo random numbers that do not depend on the C library:
+static unsigned int
+random_number(unsigned int limit)
+{
+  static unsigned long seed = 1;
+  seed = seed * 1103515245 + 12345;
+  return (seed / 65536) % limit;
+}
+
+// Random text made of the characters the filters care about:
+static wstring
+random_text(unsigned int length)
+{
+  static const wstring chars(L"aeoux AEZ 0123456789 .,;:!?-+*/%$#@&'\"()[]<>_~\n "
+                             L"\x0430\x0435\x0451\x0416\x044f \x00e9\x00e0\x00f1\x00e7\x00fc\x00df "
+                             L"\x00ab\x00bb\x2014\x00a0\x20ac\x00b0");
+  wstring text;
+  for (unsigned int i = 0; i < length; i++)
+    text += chars[random_number(chars.length())];
+  return text;
+}
+
+int
+main(void)
+{
+  const unsigned int random_samples = 3000;
+  const char* srcdir = getenv("srcdir");
+  string corpus_path(srcdir ? srcdir : ".");
+  corpus_path += "/corpus.txt";
+  ifstream corpus(corpus_path.c_str());
+  if (!corpus)
+    {
+      cerr << "Cannot read " << corpus_path << endl;
+      return EXIT_FAILURE;
+    }
+
+  locale::global(boost::locale::generator().generate("en_US.UTF-8"));
+
+  // Line breaks inside the sample utterances are marked by "\n":
+  vector<wstring> samples;
+  string line;
+  while (getline(corpus, line))
+    {
+      for (string::size_type pos = line.find("\\n"); pos != string::npos; pos = line.find("\\n", pos))
+        line.replace(pos, 2, "\n");
+      samples.push_back(intern_string(line, "UTF-8"));
+    }
+  for (unsigned int i = 0; i < random_samples; i++)
+    samples.push_back(random_text(random_number(60)));
+
+  unsigned int checked = 0, failed = 0;
+  static const struct
+  {
+    const char* title;
+    substitution_set group;
+    unsigned int passes;
+    const wchar_t* text;
+    const wchar_t* expected;
+  } sets[] =
+    {
+      { "Independent rules",
+        substitution_set()(L"a", L"1")(L"b", L"2")(L"C", L"3", true),
+        1, L"abcABC", L"123AB3\n" },
+      { "Subexpression references",
+        substitution_set()(L"(a)(b)", L"$2$1")(L"(c)(d)", L"${2}$1$$")(L"e", L"<$&>"),
+        1, L"abcde", L"badc$<e>\n" },
+      { "Rule matching inserted text",
+        substitution_set()(L"a", L"b")(L"b", L"c")(L"d", L"e"),
+        2, L"abd", L"cce\n" },
+      { "Back reference",
+        substitution_set()(L"x", L"y")(L"(z)\\1", L"w"),
+        2, L"xzz", L"yw\n" }
+    };
+  for (unsigned int i = 0; i < sizeof(sets) / sizeof(sets[0]); i++)
+    {
+      if (!check_set(sets[i].title, sets[i].group, sets[i].passes,
+                     sets[i].text, sets[i].expected))
+        failed++;
+      checked++;
+    }
+
+  vector< boost::shared_ptr<language_description> > merged, separate;
+  substitution_set::merging = true;
+  make_languages(merged);
+  substitution_set::merging = false;
+  make_languages(separate);
+
+  static const punctuations::mode modes[] =
+    {
+      punctuations::all,
+      punctuations::some,
+      punctuations::none
+    };
+  for (unsigned int i = 0; i < merged.size(); i++)
+    for (unsigned int mode = 0; mode < sizeof(modes) / sizeof(punctuations::mode); mode++)
+      {
+        filter_context context(modes[mode]);
+        for (unsigned int sample = 0; sample < samples.size(); sample++)
+          {
+            wstring result(merged[i]->filter(samples[sample], context));
+            wstring reference(separate[i]->filter(samples[sample], context));
+            if (result != reference)
+              {
+                if (failed < 10)
+                  cerr << merged[i]->id << ", mode " << modes[mode]
+                       << ": mismatch for \"" << extern_string(samples[sample], "UTF-8")
+                       << "\":\n  " << extern_string(result, "UTF-8") << "\ninstead of\n  "
+                       << extern_string(reference, "UTF-8") << endl;
+                failed++;
+              }
+            checked++;
+          }
+      }
+
+  cout << checked << " samples checked, " << failed << " mismatches" << endl;
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
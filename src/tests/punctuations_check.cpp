@@ -0,0 +1,144 @@
+// punctuations_check.cpp -- Verbose punctuations differential check
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// The punctuations filter expands the text in one pass by the position
+// table. Here its output is compared with the reference expansion,
+// that replaces listed characters one by one, as the filter used to do.
+// Pronunciation lists are made up so, that they contain punctuation
+// characters from both sides of their own position in the list,
+// and the sample texts are taken from the corpus and generated
+// at random. Every verbosity level is checked.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/replace.hpp>
+
+#include "text_filter.hpp"
+#include "strcvt.hpp"
+
+using namespace std;
+using namespace boost::algorithm;
+
+
+// Punctuation characters in the pronunciations list order:
+static const wstring char_list(L"!'?,.;:-@#$%^&*_()+=[]{}\\|\"/`~<>");
+
+// Reference expansion:
+static wstring
+expand(const wstring& src, const vector<wstring>& pronunciations, unsigned int verbosity)
+{
+  wstring result(src);
+  for (unsigned int i = verbosity; i < char_list.length(); i++)
+    replace_all(result, char_list.substr(i, 1), pronunciations[i]);
+  return result;
+}
+
+// Pseudo random numbers that do not depend on the C library:
+static unsigned int
+random_number(unsigned int limit)
+{
+  static unsigned long seed = 1;
+  seed = seed * 1103515245 + 12345;
+  return (seed / 65536) % limit;
+}
+
+// Random text made of punctuations, letters, spaces
+// and some characters beyond ASCII:
+static wstring
+random_text(unsigned int length)
+{
+  static const wstring letters(L"ab Z9\x0416\x00e9\x2014\x00ab\x00bb \x00a0");
+  wstring text;
+  for (unsigned int i = 0; i < length; i++)
+    text += random_number(3) ?
+      char_list[random_number(char_list.length())] :
+      letters[random_number(letters.length())];
+  return text;
+}
+
+int
+main(void)
+{
+  const unsigned int lists = 8;
+  const unsigned int random_samples = 2000;
+  const char* srcdir = getenv("srcdir");
+  string corpus_path(srcdir ? srcdir : ".");
+  corpus_path += "/corpus.txt";
+  ifstream corpus(corpus_path.c_str());
+  if (!corpus)
+    {
+      cerr << "Cannot read " << corpus_path << endl;
+      return EXIT_FAILURE;
+    }
+
+  vector<wstring> samples;
+  string line;
+  while (getline(corpus, line))
+    samples.push_back(intern_string(line, "UTF-8"));
+  for (unsigned int i = 0; i < random_samples; i++)
+    samples.push_back(random_text(random_number(40)));
+
+  unsigned int checked = 0, failed = 0;
+  for (unsigned int list = 0; list < lists; list++)
+    {
+      // The first list holds plain words, the rest are filled
+      // with punctuations at random:
+      vector<wstring> pronunciations(punctuations::count);
+      const wchar_t* pronunciations_list[punctuations::count];
+      for (unsigned int i = 0; i < punctuations::count; i++)
+        {
+          pronunciations[i] = L" p";
+          pronunciations[i] += wchar_t(L'a' + i % 26);
+          if (list)
+            pronunciations[i] += random_text(random_number(6));
+          pronunciations[i] += L' ';
+          pronunciations_list[i] = pronunciations[i].c_str();
+        }
+      punctuations stage(pronunciations_list);
+
+      for (unsigned int verbosity = punctuations::all; verbosity <= punctuations::count; verbosity++)
+        {
+          filter_context context(static_cast<punctuations::mode>(verbosity));
+          for (unsigned int i = 0; i < samples.size(); i++)
+            {
+              wstring result;
+              stage.apply(samples[i], result, context);
+              if (result != expand(samples[i], pronunciations, verbosity))
+                {
+                  if (!failed)
+                    cerr << "List " << list << ", verbosity " << verbosity
+                         << ": mismatch for \"" << extern_string(samples[i], "UTF-8")
+                         << "\":\n  " << extern_string(result, "UTF-8") << "\ninstead of\n  "
+                         << extern_string(expand(samples[i], pronunciations, verbosity), "UTF-8")
+                         << endl;
+                  failed++;
+                }
+              checked++;
+            }
+        }
+    }
+
+  cout << checked << " samples checked, " << failed << " mismatches" << endl;
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+// queue_bench.cpp -- Jobs queue benchmark
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Usage: queue_bench
+//
+// Tones, index marks and silences are submitted to the jobs queue
+// by batches and dispatched one by one, as the sound manager does.
+// The ring queue it uses now is compared with the linked list
+// it used before. For each job kind the time and the number
+// of heap allocations per submitted and dispatched job are reported.
+// The timing is taken as the best of several trials by the thread
+// CPU clock, so other processes running on the same machine
+// affect it as little as possible.
+
+#include <time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <string>
+
+#include <boost/blank.hpp>
+#include <boost/variant.hpp>
+
+#include "ring_queue.hpp"
+#include "file_player.hpp"
+#include "tone_generator.hpp"
+#include "loudspeaker.hpp"
+
+using namespace std;
+
+
+// Queued job as it is defined by the sound manager:
+typedef boost::variant<boost::blank, sound_task, tone_task,
+                       speech_task, string> job;
+
+// Heap allocations counter:
+static unsigned long allocations = 0;
+
+void*
+operator new(size_t size)
+{
+  void* block = malloc(size ? size : 1);
+  if (!block)
+    throw bad_alloc();
+  allocations++;
+  return block;
+}
+
+// It is kept out of line, so the compiler does not take the free()
+// call for a mismatched deallocation:
+void __attribute__((noinline))
+operator delete(void* block) throw()
+{
+  free(block);
+}
+
+// Thread CPU time in microseconds:
+static double
+cpu_time(void)
+{
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+// Job kinds being measured:
+enum job_kind
+{
+  tones,
+  marks,
+  silences
+};
+
+static const char* const kind_names[] =
+  {
+    "tones",
+    "marks",
+    "silences"
+  };
+
+// Make up a job of specified kind:
+static job
+make_job(job_kind kind, unsigned int n)
+{
+  switch (kind)
+    {
+    case tones:
+      return job(tone_task(440 + n, 0.05));
+    case marks:
+      return job(string("mark") + char('0' + n % 10));
+    default:
+      return job(speech_task(22050, 1000 + n));
+    }
+}
+
+// Submit a batch of jobs and dispatch them all. Returns
+// the number of jobs passed through the queue:
+template <typename queue_type>
+static unsigned int
+cycle(queue_type& queue, job_kind kind)
+{
+  const unsigned int batch = 32;
+  unsigned int dispatched = 0;
+  for (unsigned int i = 0; i < batch; i++)
+    queue.push_back(make_job(kind, i));
+  while (!queue.empty())
+    {
+      if (queue.front().which() != 0)
+        dispatched++;
+      queue.pop_front();
+    }
+  return dispatched;
+}
+
+// Measure the queue and print the results:
+template <typename queue_type>
+static void
+measure(const char* title)
+{
+  const unsigned int warmup_rounds = 100;
+  const unsigned int trials = 5;
+  const unsigned int rounds = 10000;
+  for (unsigned int kind = tones; kind <= silences; kind++)
+    {
+      queue_type queue;
+      for (unsigned int round = 0; round < warmup_rounds; round++)
+        cycle(queue, static_cast<job_kind>(kind));
+      double best = 0.0;
+      unsigned long allocated = 0;
+      unsigned long jobs = 0;
+      for (unsigned int trial = 0; trial < trials; trial++)
+        {
+          unsigned long start_allocations = allocations;
+          double start = cpu_time();
+          jobs = 0;
+          for (unsigned int round = 0; round < rounds; round++)
+            jobs += cycle(queue, static_cast<job_kind>(kind));
+          double elapsed = cpu_time() - start;
+          if (!trial || (elapsed < best))
+            best = elapsed;
+          allocated = allocations - start_allocations;
+        }
+      printf("%s, %s: %.1f ns/job, %.2f allocs/job\n", title, kind_names[kind],
+             best * 1e3 / jobs, static_cast<double>(allocated) / jobs);
+    }
+}
+
+int
+main(void)
+{
+  measure< list<job> >("list");
+  measure< ring_queue<job> >("ring");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,290 @@
+// ssml_check.cpp -- SSML parser check
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Sample messages, well formed and malformed ones, are parsed
+// and the resulting items are compared with the expected ones.
+// Then these samples along with the messages made up at random
+// of markup, character references and text fragments are passed
+// to the incremental parser line by line, as they are received
+// by the Speech Dispatcher frontend, with several thresholds.
+// The items are expected to be the same as the ones got by parsing
+// whole message, except that the text may be split in more parts.
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ssml_parser.hpp"
+#include "strcvt.hpp"
+
+using namespace std;
+
+
+// Expected message item. Text items are marked by null mark name:
+static const struct sample_item
+{
+  const wchar_t* text;
+  const wchar_t* mark;
+  double volume, rate, pitch;
+  const char* language;
+  bool spelling;
+} end_of_items = { NULL, NULL, 0.0, 0.0, 0.0, NULL, false };
+
+// Sample message along with the items it should be parsed to:
+static const struct
+{
+  const wchar_t* message;
+  sample_item items[5];
+} samples[] =
+  {
+    // Plain text:
+    { L"Hello, world!",
+      { { L"Hello, world!", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"Two\nlines",
+      { { L"Two\nlines", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+
+    // Index marks:
+    { L"Say <mark name=\"m1\"/>now<mark name='m2' />",
+      { { L"Say ", NULL, 1.0, 1.0, 1.0, "", false },
+        { NULL, L"m1", 0.0, 0.0, 0.0, NULL, false },
+        { L"now", NULL, 1.0, 1.0, 1.0, "", false },
+        { NULL, L"m2", 0.0, 0.0, 0.0, NULL, false },
+        end_of_items } },
+
+    // Prosody, say-as and language changes in the element scope:
+    { L"a <prosody rate=\"fast\" pitch=\"+12st\" volume=\"50%\">b</prosody> c",
+      { { L"a ", NULL, 1.0, 1.0, 1.0, "", false },
+        { L"b", NULL, 0.5, 1.5, 2.0, "", false },
+        { L" c", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"<prosody rate=\"slow\">x<prosody rate=\"200%\">y</prosody></prosody>",
+      { { L"x", NULL, 1.0, 0.75, 1.0, "", false },
+        { L"y", NULL, 1.0, 1.5, 1.0, "", false },
+        end_of_items } },
+    { L"Key <say-as interpret-as=\"characters\">abc</say-as>.",
+      { { L"Key ", NULL, 1.0, 1.0, 1.0, "", false },
+        { L"abc", NULL, 1.0, 1.0, 1.0, "", true },
+        { L".", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"<voice xml:lang=\"ru-RU\">\x0434\x0430</voice> <lang language=\"DE\">ja</lang>",
+      { { L"\x0434\x0430", NULL, 1.0, 1.0, 1.0, "ru", false },
+        { L" ", NULL, 1.0, 1.0, 1.0, "", false },
+        { L"ja", NULL, 1.0, 1.0, 1.0, "de", false },
+        end_of_items } },
+
+    // Unknown elements, comments and declarations are stripped:
+    { L"<?xml version=\"1.0\"?><speak><!-- note --><p>one</p> <s>two</s></speak>",
+      { { L"one two", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+
+    // Character references:
+    { L"&lt;tag&gt; &amp; &quot;&apos; &#65;&#x42;&#X43;",
+      { { L"<tag> & \"' ABC", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+
+    // Malformed markup is kept as plain text:
+    { L"5 < 7 and 9 > 8",
+      { { L"5 < 7 and 9 > 8", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"a <b and <> c <",
+      { { L"a <b and <> c <", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"<mark\nname=\"x\"/>",
+      { { L"<mark\nname=\"x\"/>", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"&foo; &amp &#; &#xZZ; &#0; &",
+      { { L"&foo; &amp &#; &#xZZ; &#0; &", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+
+    // Unmatched end tags are ignored, unclosed elements last
+    // up to the message end or the enclosing element end,
+    // and unrecognized prosody values are ignored:
+    { L"</prosody>x<prosody rate=\"slow\">y",
+      { { L"x", NULL, 1.0, 1.0, 1.0, "", false },
+        { L"y", NULL, 1.0, 0.75, 1.0, "", false },
+        end_of_items } },
+    { L"<p><prosody volume=\"loud\">x</p>y",
+      { { L"x", NULL, 1.5, 1.0, 1.0, "", false },
+        { L"y", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } },
+    { L"<prosody rate=\"fastest\" pitch=\"7\">x</prosody><mark/>",
+      { { L"x", NULL, 1.0, 1.0, 1.0, "", false },
+        end_of_items } }
+  };
+
+// Check if two numbers are close enough:
+static bool
+close(double a, double b)
+{
+  return fabs(a - b) < 1e-6;
+}
+
+// Compare parsed item with the expected one:
+static bool
+matches(const ssml_parser::item& found, const sample_item& expected)
+{
+  if (expected.mark)
+    return (found.type == ssml_parser::item::mark) &&
+      (found.content == expected.mark);
+  return (found.type == ssml_parser::item::text) &&
+    (found.content == expected.text) &&
+    close(found.volume, expected.volume) &&
+    close(found.rate, expected.rate) &&
+    close(found.pitch, expected.pitch) &&
+    (found.language == expected.language) &&
+    (found.spelling == expected.spelling);
+}
+
+// Check if the text items are spoken alike:
+static bool
+alike(const ssml_parser::item& a, const ssml_parser::item& b)
+{
+  return (a.type == ssml_parser::item::text) &&
+    (b.type == ssml_parser::item::text) &&
+    (a.volume == b.volume) && (a.rate == b.rate) &&
+    (a.pitch == b.pitch) && (a.language == b.language) &&
+    (a.spelling == b.spelling);
+}
+
+// Append items joining adjacent text spoken alike:
+static void
+append(vector<ssml_parser::item>& destination,
+       const vector<ssml_parser::item>& items)
+{
+  for (unsigned int i = 0; i < items.size(); i++)
+    if (!destination.empty() && alike(destination.back(), items[i]))
+      destination.back().content += items[i].content;
+    else destination.push_back(items[i]);
+}
+
+// Check if two item lists are the same:
+static bool
+same(const vector<ssml_parser::item>& a, const vector<ssml_parser::item>& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (unsigned int i = 0; i < a.size(); i++)
+    if ((a[i].type != b[i].type) || (a[i].content != b[i].content) ||
+        ((a[i].type == ssml_parser::item::text) && !alike(a[i], b[i])))
+      return false;
+  return true;
+}
+
+// Pseudo random numbers that do not depend on the C library:
+static unsigned int
+random_number(unsigned int limit)
+{
+  static unsigned long seed = 1;
+  seed = seed * 1103515245 + 12345;
+  return (seed / 65536) % limit;
+}
+
+// Random message made of markup, references and text fragments:
+static wstring
+random_message(unsigned int length)
+{
+  static const wchar_t* const fragments[] =
+    {
+      L"word", L" ", L" ", L"\n", L". ", L"! ", L"?\" ", L"... ",
+      L"\x0441\x043b\x043e\x0432\x043e", L"<", L">", L"&", L";",
+      L"&amp;", L"&lt;", L"&#x44F;", L"&bogus;",
+      L"<mark name=\"m\"/>", L"<mark name='n'/>",
+      L"<prosody rate=\"fast\">", L"<prosody pitch=\"-2st\" volume=\"+6dB\">",
+      L"</prosody>", L"<say-as interpret-as=\"characters\">", L"</say-as>",
+      L"<voice xml:lang=\"ru\">", L"</voice>", L"<lang language=\"fr\">",
+      L"</lang>", L"<p>", L"</p>", L"<!-- c -->", L"</unknown>"
+    };
+  wstring message;
+  for (unsigned int i = 0; i < length; i++)
+    message += fragments[random_number(sizeof(fragments) / sizeof(const wchar_t*))];
+  return message;
+}
+
+// Pass the message to the incremental parser by lines:
+static vector<ssml_parser::item>
+feed_lines(ssml_parser& parser, const wstring& message, size_t threshold)
+{
+  vector<ssml_parser::item> result;
+  parser.start();
+  wstring::size_type start = 0;
+  while (start < message.length())
+    {
+      wstring::size_type end = message.find(L'\n', start);
+      end = (end == wstring::npos) ? message.length() : (end + 1);
+      append(result, parser.feed(message.substr(start, end - start), threshold));
+      start = end;
+    }
+  append(result, parser.finish());
+  return result;
+}
+
+int
+main(void)
+{
+  const unsigned int random_samples = 3000;
+  static const size_t thresholds[] = { 1, 8, 64, 100000 };
+  ssml_parser parser;
+  unsigned int checked = 0, failed = 0;
+
+  vector<wstring> messages;
+  for (unsigned int i = 0; i < sizeof(samples) / sizeof(samples[0]); i++)
+    {
+      const vector<ssml_parser::item>& items = parser.parse(samples[i].message);
+      unsigned int n = 0;
+      while ((n < items.size()) && (samples[i].items[n].text || samples[i].items[n].mark) &&
+             matches(items[n], samples[i].items[n]))
+        n++;
+      if ((n < items.size()) || samples[i].items[n].text || samples[i].items[n].mark)
+        {
+          cerr << "Parsing \"" << extern_string(samples[i].message, "UTF-8")
+               << "\": item " << n << " mismatch" << endl;
+          failed++;
+        }
+      checked++;
+      messages.push_back(samples[i].message);
+    }
+
+  for (unsigned int i = 0; i < random_samples; i++)
+    messages.push_back(random_message(random_number(40)));
+  for (unsigned int i = 0; i < messages.size(); i++)
+    {
+      vector<ssml_parser::item> whole;
+      append(whole, parser.parse(messages[i]));
+      for (unsigned int t = 0; t < sizeof(thresholds) / sizeof(size_t); t++)
+        {
+          if (!same(feed_lines(parser, messages[i], thresholds[t]), whole))
+            {
+              if (failed < 10)
+                cerr << "Feeding \"" << extern_string(messages[i], "UTF-8")
+                     << "\" by lines with threshold " << thresholds[t]
+                     << ": items differ from parsing" << endl;
+              failed++;
+            }
+          checked++;
+        }
+    }
+
+  cout << checked << " samples checked, " << failed << " mismatches" << endl;
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
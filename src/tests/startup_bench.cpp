@@ -0,0 +1,102 @@
+// startup_bench.cpp -- Language setup cost benchmark
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Usage: startup_bench
+//
+// All the languages are constructed and prepared the same way
+// the speech server does it when every language is configured.
+// Then the whole process CPU time is reported including dynamic
+// linking and static data initialization, along with the part
+// of it taken by the languages and the peak memory usage.
+// Speech backend processes and audio output are not involved.
+// The program should be run several times, since only the first
+// run pays for reading the libraries from disk.
+
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <boost/locale/generator.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "English.hpp"
+#include "Russian.hpp"
+#include "German.hpp"
+#include "French.hpp"
+#include "Spanish.hpp"
+#include "Italian.hpp"
+#include "Portuguese.hpp"
+#include "config.hpp"
+
+using namespace std;
+
+
+// Thread CPU time in milliseconds:
+static double
+cpu_time(void)
+{
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+int
+main(void)
+{
+  double start = cpu_time();
+  locale::global(boost::locale::generator().generate("en_US.UTF-8"));
+  double locale_ready = cpu_time();
+
+  language_description::add_alphabet(lang_id::en, English::alphabet);
+  language_description::add_alphabet(lang_id::ru, Russian::alphabet);
+  language_description::add_alphabet(lang_id::de, German::alphabet);
+  language_description::add_alphabet(lang_id::fr, French::alphabet);
+  language_description::add_alphabet(lang_id::es, Spanish::alphabet);
+  language_description::add_alphabet(lang_id::it, Italian::alphabet);
+  language_description::add_alphabet(lang_id::pt, Portuguese::alphabet);
+  vector< boost::shared_ptr<language_description> > languages;
+  languages.push_back(boost::shared_ptr<language_description>(new English));
+  languages.push_back(boost::shared_ptr<language_description>(new Russian));
+  languages.push_back(boost::shared_ptr<language_description>(new German));
+  languages.push_back(boost::shared_ptr<language_description>(new French));
+  languages.push_back(boost::shared_ptr<language_description>(new Spanish));
+  languages.push_back(boost::shared_ptr<language_description>(new Italian));
+  languages.push_back(boost::shared_ptr<language_description>(new Portuguese));
+  double constructed = cpu_time();
+  for (unsigned int i = 0; i < languages.size(); i++)
+    languages[i]->prepare();
+  double prepared = cpu_time();
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  double total = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 +
+    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+  printf("process: %.1f ms CPU, %ld KB peak RSS\n", total, usage.ru_maxrss);
+  printf("  before main: %.1f ms\n", start);
+  printf("  locale: %.1f ms\n", locale_ready - start);
+  printf("  language construction: %.1f ms\n", constructed - locale_ready);
+  printf("  detectors and dictionaries: %.1f ms\n", prepared - constructed);
+
+  return EXIT_SUCCESS;
+}
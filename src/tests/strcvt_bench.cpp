@@ -0,0 +1,217 @@
+// strcvt_bench.cpp -- Charset conversion benchmark
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Usage: strcvt_bench
+//
+// The corpus lines are decoded from the frontend charsets
+// and encoded to the backend ones, UTF-8 and KOI8-R, as the speech
+// servers do it. Pure ASCII lines and the rest are measured apart.
+// The charset converters used now are compared with the Boost.Locale
+// conversion by charset name used before. For each case the time
+// and the number of heap allocations per call are reported.
+// The timing is taken as the best of several trials by the thread
+// CPU clock, so other processes running on the same machine
+// affect it as little as possible.
+
+#include <time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/locale/encoding.hpp>
+
+#include "strcvt.hpp"
+
+using namespace std;
+using namespace boost::locale::conv;
+
+
+// Heap allocations counter:
+static unsigned long allocations = 0;
+
+void*
+operator new(size_t size)
+{
+  void* block = malloc(size ? size : 1);
+  if (!block)
+    throw bad_alloc();
+  allocations++;
+  return block;
+}
+
+// It is kept out of line, so the compiler does not take the free()
+// call for a mismatched deallocation:
+void __attribute__((noinline))
+operator delete(void* block) throw()
+{
+  free(block);
+}
+
+// Thread CPU time in microseconds:
+static double
+cpu_time(void)
+{
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+}
+
+// Conversion methods being compared:
+
+class converter_method
+{
+public:
+  static const char* name(void)
+  {
+    return "converter";
+  }
+
+  static size_t decode(const string& s, const char* charset)
+  {
+    return intern_string(s, charset).length();
+  }
+
+  static size_t encode(const wstring& s, const char* charset)
+  {
+    return extern_string(s, charset).length();
+  }
+};
+
+class locale_method
+{
+public:
+  static const char* name(void)
+  {
+    return "boost.locale";
+  }
+
+  static size_t decode(const string& s, const char* charset)
+  {
+    return to_utf<wchar_t>(s, charset).length();
+  }
+
+  static size_t encode(const wstring& s, const char* charset)
+  {
+    return from_utf(s, charset).length();
+  }
+};
+
+// Bring both directions to the same signature:
+template <typename method>
+static size_t
+convert(const string& s, const char* charset)
+{
+  return method::decode(s, charset);
+}
+
+template <typename method>
+static size_t
+convert(const wstring& s, const char* charset)
+{
+  return method::encode(s, charset);
+}
+
+// Measure decoding or encoding of the samples and print the results:
+template <typename method, typename sample>
+static void
+measure(const char* direction, const char* charset, const char* kind,
+        const vector<sample>& samples)
+{
+  const unsigned int trials = 5;
+  const unsigned int rounds = 20;
+  if (samples.empty())
+    return;
+  double best = 0.0;
+  unsigned long allocated = 0;
+  size_t total = 0;
+  for (unsigned int trial = 0; trial < trials; trial++)
+    {
+      unsigned long start_allocations = allocations;
+      double start = cpu_time();
+      for (unsigned int round = 0; round < rounds; round++)
+        for (unsigned int i = 0; i < samples.size(); i++)
+          total += convert<method>(samples[i], charset);
+      double elapsed = cpu_time() - start;
+      if (!trial || (elapsed < best))
+        best = elapsed;
+      allocated = allocations - start_allocations;
+    }
+  double calls = rounds * samples.size();
+  printf("%s %s, %s, %s: %.0f ns/call, %.1f allocs/call\n",
+         direction, charset, kind, method::name(),
+         best * 1e3 / calls, allocated / calls);
+  if (!total)
+    printf("  nothing converted\n");
+}
+
+// Check if the text is pure ASCII:
+static bool
+ascii(const wstring& s)
+{
+  for (unsigned int i = 0; i < s.length(); i++)
+    if (static_cast<unsigned int>(s[i]) >= 0x80)
+      return false;
+  return true;
+}
+
+int
+main(void)
+{
+  static const char* const charsets[] = { "UTF-8", "KOI8-R" };
+  const char* srcdir = getenv("srcdir");
+  string corpus_path(srcdir ? srcdir : ".");
+  corpus_path += "/corpus.txt";
+  ifstream corpus(corpus_path.c_str());
+  if (!corpus)
+    {
+      cerr << "Cannot read " << corpus_path << endl;
+      return EXIT_FAILURE;
+    }
+
+  // Sample texts split by kind:
+  vector<wstring> texts[2];
+  string line;
+  while (getline(corpus, line))
+    {
+      wstring text(intern_string(line, "UTF-8"));
+      texts[ascii(text) ? 0 : 1].push_back(text);
+    }
+  static const char* const kinds[] = { "ascii", "national" };
+
+  for (unsigned int charset = 0; charset < sizeof(charsets) / sizeof(const char*); charset++)
+    for (unsigned int kind = 0; kind < 2; kind++)
+      {
+        // Frontend input is the text in that charset:
+        vector<string> input;
+        for (unsigned int i = 0; i < texts[kind].size(); i++)
+          input.push_back(extern_string(texts[kind][i], charsets[charset]));
+        measure<locale_method>("decode", charsets[charset], kinds[kind], input);
+        measure<converter_method>("decode", charsets[charset], kinds[kind], input);
+        measure<locale_method>("encode", charsets[charset], kinds[kind], texts[kind]);
+        measure<converter_method>("encode", charsets[charset], kinds[kind], texts[kind]);
+      }
+
+  return EXIT_SUCCESS;
+}
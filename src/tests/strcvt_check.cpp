@@ -0,0 +1,147 @@
+// strcvt_check.cpp -- Charset conversion check
+/*
+   Copyright (C) 2008 Igor B. Poretsky <poretsky@mlbox.ru>
+   This file is part of Multispeech.
+
+   Multispeech is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   Multispeech is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Multispeech; if not, write to the Free Software Foundation,
+   Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+// Sample texts are encoded in several charsets and compared
+// with their known representations, then decoded back and compared
+// with the original. The stateful ISO-2022-JP encoding is included,
+// since its output consists of ASCII codes only and must still
+// be passed through iconv, and it must end in the initial state.
+// Characters that cannot be represented and invalid input
+// are expected to be skipped.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "strcvt.hpp"
+
+using namespace std;
+
+
+// Sample text and its representation in specified charset:
+static const struct
+{
+  const char* charset;
+  const wchar_t* text;
+  const char* bytes;
+} samples[] =
+  {
+    { "KOI8-R", L"\x041f\x0440\x0438\x0432\x0435\x0442, world!",
+      "\xf0\xd2\xc9\xd7\xc5\xd4, world!" },
+    { "KOI8-R", L"\x0451\x0416\x044f", "\xa3\xf6\xd1" },
+    { "KOI8-R", L"plain ASCII text", "plain ASCII text" },
+    { "CP1251", L"\x0416\x0443\x043a", "\xc6\xf3\xea" },
+    { "ISO-8859-1", L"caf\x00e9", "caf\xe9" },
+    { "UTF-8", L"\x0416 \x00e9 \x65e5 \x2014", "\xd0\x96 \xc3\xa9 \xe6\x97\xa5 \xe2\x80\x94" },
+    { "ISO-2022-JP", L"\x65e5\x672c\x8a9e", "\x1b$BF|K\\8l\x1b(B" },
+    { "ISO-2022-JP", L"abc \x65e5 def", "abc \x1b$BF|\x1b(B def" }
+  };
+
+// Text with characters missing in the charset
+// and the representation of the rest:
+static const struct
+{
+  const char* charset;
+  const wchar_t* text;
+  const char* bytes;
+} lossy_samples[] =
+  {
+    { "KOI8-R", L"a\x00e9\x0416\x65e5z", "a\xf6z" },
+    { "ISO-8859-1", L"x\x0416y", "xy" }
+  };
+
+// Invalid input and the text it should be decoded to:
+static const struct
+{
+  const char* charset;
+  const char* bytes;
+  const wchar_t* text;
+} invalid_samples[] =
+  {
+    { "UTF-8", "a\xff" "b\xd0", L"ab" },
+    { "UTF-8", "\xc3\xa9\x80x", L"\x00e9x" }
+  };
+
+// Report mismatch:
+static void
+report(const char* what, const char* charset, const wstring& text)
+{
+  cerr << what << " mismatch in " << charset << " for \""
+       << extern_string(text, "UTF-8") << '"' << endl;
+}
+
+int
+main(void)
+{
+  unsigned int checked = 0, failed = 0;
+
+  for (unsigned int i = 0; i < sizeof(samples) / sizeof(samples[0]); i++)
+    {
+      extern_string encoded(samples[i].text, samples[i].charset);
+      if (encoded != samples[i].bytes)
+        {
+          report("Encoding", samples[i].charset, samples[i].text);
+          failed++;
+        }
+      intern_string decoded(samples[i].bytes, samples[i].charset);
+      if (decoded != samples[i].text)
+        {
+          report("Decoding", samples[i].charset, samples[i].text);
+          failed++;
+        }
+      if (intern_string(encoded, samples[i].charset) != samples[i].text)
+        {
+          report("Round trip", samples[i].charset, samples[i].text);
+          failed++;
+        }
+      checked += 3;
+    }
+
+  for (unsigned int i = 0; i < sizeof(lossy_samples) / sizeof(lossy_samples[0]); i++)
+    {
+      if (extern_string(lossy_samples[i].text, lossy_samples[i].charset) != lossy_samples[i].bytes)
+        {
+          report("Lossy encoding", lossy_samples[i].charset, lossy_samples[i].text);
+          failed++;
+        }
+      checked++;
+    }
+
+  for (unsigned int i = 0; i < sizeof(invalid_samples) / sizeof(invalid_samples[0]); i++)
+    {
+      if (intern_string(invalid_samples[i].bytes, invalid_samples[i].charset) != invalid_samples[i].text)
+        {
+          report("Invalid input decoding", invalid_samples[i].charset, invalid_samples[i].text);
+          failed++;
+        }
+      checked++;
+    }
+
+  // Converters are kept for reuse:
+  if (&charset_converter::get("KOI8-R") != &charset_converter::get("KOI8-R"))
+    {
+      cerr << "Converter is not reused" << endl;
+      failed++;
+    }
+  checked++;
+
+  cout << checked << " conversions checked, " << failed << " mismatches" << endl;
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}